@@ -0,0 +1,94 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+static t_arena_chunk *new_chunk(size_t size)
+{
+    t_arena_chunk *chunk;
+
+    if (size < ARENA_CHUNK)
+        size = ARENA_CHUNK;
+    chunk = malloc(sizeof(t_arena_chunk) + size + ARENA_ALIGN);
+    if (!chunk)
+        return (NULL);
+    chunk->data = (char *)(((uintptr_t)(chunk + 1) + ARENA_ALIGN - 1)
+                           & ~(uintptr_t)(ARENA_ALIGN - 1));
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->next = NULL;
+    return (chunk);
+}
+
+// Returns ARENA_ALIGN aligned, uninitialized memory, or NULL
+void *arena_alloc(t_arena *arena, size_t size)
+{
+    t_arena_chunk *chunk = arena->head;
+    void *ptr;
+
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (!chunk || chunk->size - chunk->used < size)
+    {
+        chunk = new_chunk(size);
+        if (!chunk)
+            return (NULL);
+        chunk->next = arena->head;
+        arena->head = chunk;
+    }
+    ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    return (ptr);
+}
+
+t_arena_mark arena_mark(t_arena *arena)
+{
+    t_arena_mark mark;
+
+    mark.chunk = arena->head;
+    mark.used = arena->head ? arena->head->used : 0;
+    return (mark);
+}
+
+// Release everything allocated since `mark`
+void arena_rewind(t_arena *arena, t_arena_mark mark)
+{
+    t_arena_chunk *next;
+
+    while (arena->head && arena->head != mark.chunk)
+    {
+        next = arena->head->next;
+        free(arena->head);
+        arena->head = next;
+    }
+    if (arena->head)
+        arena->head->used = mark.used;
+}
+
+// Release everything, but keep the largest chunk so reloading a level of
+// the same size does not go back to malloc
+void arena_reset(t_arena *arena)
+{
+    t_arena_chunk *chunk, *next, *keep = NULL;
+
+    for (chunk = arena->head; chunk; chunk = chunk->next)
+        if (!keep || chunk->size > keep->size)
+            keep = chunk;
+    for (chunk = arena->head; chunk; chunk = next)
+    {
+        next = chunk->next;
+        if (chunk != keep)
+            free(chunk);
+    }
+    arena->head = keep;
+    if (keep)
+    {
+        keep->next = NULL;
+        keep->used = 0;
+    }
+}
+
+void arena_destroy(t_arena *arena)
+{
+    arena_reset(arena);
+    free(arena->head);
+    arena->head = NULL;
+}
@@ -0,0 +1,39 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+// Bump allocator for memory that lives exactly as long as a level: the map
+// grid, the damage grid and scratch buffers. Everything is released at once
+// by arena_reset when the next level loads; nothing is freed individually.
+
+#include <stddef.h>
+
+#define ARENA_ALIGN 64          // Every allocation starts on a cache line
+#define ARENA_CHUNK (1 << 16)   // Minimum chunk size requested from malloc
+
+typedef struct s_arena_chunk
+{
+    struct s_arena_chunk    *next;  // Older chunk
+    char                    *data;  // ARENA_ALIGN aligned start of the usable space
+    size_t                  size;
+    size_t                  used;
+} t_arena_chunk;
+
+typedef struct s_arena
+{
+    t_arena_chunk   *head;  // Chunk currently being filled
+} t_arena;
+
+// Position to rewind to when a scratch buffer is no longer needed
+typedef struct s_arena_mark
+{
+    t_arena_chunk   *chunk;
+    size_t          used;
+} t_arena_mark;
+
+void            *arena_alloc(t_arena *arena, size_t size);
+t_arena_mark    arena_mark(t_arena *arena);
+void            arena_rewind(t_arena *arena, t_arena_mark mark);
+void            arena_reset(t_arena *arena);
+void            arena_destroy(t_arena *arena);
+
+#endif
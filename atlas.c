@@ -0,0 +1,310 @@
+#include "atlas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define XPM_MAX_COLORS 4096
+
+static void put_u16(FILE *file, unsigned int value)
+{
+    fputc(value & 0xFF, file);
+    fputc((value >> 8) & 0xFF, file);
+}
+
+static void put_u32(FILE *file, unsigned int value)
+{
+    put_u16(file, value & 0xFFFF);
+    put_u16(file, value >> 16);
+}
+
+static void put_u64(FILE *file, unsigned long long value)
+{
+    put_u32(file, (unsigned int)value);
+    put_u32(file, (unsigned int)(value >> 32));
+}
+
+static unsigned int get_u32(const unsigned char *p)
+{
+    return (p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24));
+}
+
+static unsigned long long get_u64(const unsigned char *p)
+{
+    return (get_u32(p) | ((unsigned long long)get_u32(p + 4) << 32));
+}
+
+// Next "quoted" string of an XPM file: its start and length, NULL at the end
+static char *next_string(char **cursor, char *end, int *length)
+{
+    char *start = memchr(*cursor, '"', end - *cursor);
+    char *stop;
+
+    if (!start)
+        return (NULL);
+    start++;
+    stop = memchr(start, '"', end - start);
+    if (!stop)
+        return (NULL);
+    *cursor = stop + 1;
+    *length = stop - start;
+    return (start);
+}
+
+// The "c" (color) value of a color line, after its key. Only "#RRGGBB" and
+// "None" are understood, which is all the assets use; anything else is
+// left to MiniLibX's own loader. Returns 0 if the value is not understood.
+static int parse_color(const char *spec, int length, unsigned int *color)
+{
+    char value[16];
+    int i = 0, n;
+
+    while (i < length)
+    {
+        while (i < length && (spec[i] == ' ' || spec[i] == '\t'))
+            i++;
+        if (i + 1 < length && spec[i] == 'c' && (spec[i + 1] == ' ' || spec[i + 1] == '\t'))
+        {
+            for (i += 2; i < length && (spec[i] == ' ' || spec[i] == '\t'); i++)
+                ;
+            for (n = 0; i + n < length && n < 15 && spec[i + n] != ' '; n++)
+                value[n] = spec[i + n];
+            value[n] = '\0';
+            if (strcmp(value, "None") == 0 || strcmp(value, "none") == 0)
+                *color = 0xFF000000;
+            else if (n == 7 && value[0] == '#' && strspn(value + 1, "0123456789abcdefABCDEF") == 6)
+                *color = (unsigned int)strtoul(value + 1, NULL, 16);
+            else
+                return (0);
+            return (1);
+        }
+        while (i < length && spec[i] != ' ' && spec[i] != '\t')
+            i++;
+    }
+    return (0);
+}
+
+static int load_file(const char *path, char **text, long *length)
+{
+    FILE *file = fopen(path, "rb");
+
+    *text = NULL;
+    if (!file)
+        return (0);
+    if (fseek(file, 0, SEEK_END) == 0 && (*length = ftell(file)) > 0
+        && fseek(file, 0, SEEK_SET) == 0 && (*text = malloc(*length)))
+    {
+        if (fread(*text, 1, *length, file) != (size_t)*length)
+        {
+            free(*text);
+            *text = NULL;
+        }
+    }
+    fclose(file);
+    return (*text != NULL);
+}
+
+// Pixels of each row, through the color keys. One-character keys (all the
+// assets) index a table; longer ones are searched.
+static int decode_rows(char **cursor, char *end, t_atlas_sprite *sprite,
+                       char (*keys)[8], unsigned int *colors, int ncolors, int cpp)
+{
+    int table[256];
+    char *row;
+    int x, y, k, length;
+
+    for (k = 0; k < 256; k++)
+        table[k] = ncolors;
+    for (k = 0; cpp == 1 && k < ncolors; k++)
+        table[(unsigned char)keys[k][0]] = k;
+    for (y = 0; y < sprite->height; y++)
+    {
+        row = next_string(cursor, end, &length);
+        if (!row || length < sprite->width * cpp)
+            return (0);
+        for (x = 0; x < sprite->width; x++)
+        {
+            if (cpp == 1)
+                k = table[(unsigned char)row[x]];
+            else
+                for (k = 0; k < ncolors && memcmp(row + x * cpp, keys[k], cpp) != 0; k++)
+                    ;
+            if (k == ncolors)
+                return (0);
+            sprite->pixels[(long)y * sprite->width + x] = colors[k];
+        }
+    }
+    return (1);
+}
+
+// Decode an XPM file into malloc'd pixels, named after the file. Thread
+// safe, unlike mlx_xpm_file_to_image. Returns 0 if the file cannot be read
+// or uses something this decoder does not handle.
+int xpm_decode(const char *path, t_atlas_sprite *sprite)
+{
+    const char *base = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    char *text, *cursor, *line;
+    int ncolors, cpp, length, i, ok = 0;
+    long size;
+
+    memset(sprite, 0, sizeof(*sprite));
+    snprintf(sprite->name, ATLAS_NAME_MAX, "%.*s", (int)strcspn(base, "."), base);
+    if (!load_file(path, &text, &size))
+        return (0);
+    cursor = text;
+    line = next_string(&cursor, text + size, &length);
+    if (line && sscanf(line, "%d %d %d %d", &sprite->width, &sprite->height,
+                       &ncolors, &cpp) == 4
+        && sprite->width > 0 && sprite->width <= ATLAS_MAX_SIDE
+        && sprite->height > 0 && sprite->height <= ATLAS_MAX_SIDE
+        && ncolors > 0 && ncolors <= XPM_MAX_COLORS && cpp >= 1 && cpp <= 7)
+    {
+        char (*key)[8] = malloc(ncolors * sizeof(*key));
+        unsigned int *color = malloc(ncolors * sizeof(*color));
+
+        sprite->pixels = malloc((size_t)sprite->width * sprite->height * sizeof(unsigned int));
+        ok = key && color && sprite->pixels;
+        for (i = 0; ok && i < ncolors; i++)
+        {
+            line = next_string(&cursor, text + size, &length);
+            ok = line && length > cpp && parse_color(line + cpp, length - cpp, &color[i]);
+            if (ok)
+                memcpy(key[i], line, cpp);
+        }
+        ok = ok && decode_rows(&cursor, text + size, sprite, key, color, ncolors, cpp);
+        free(key);
+        free(color);
+    }
+    free(text);
+    if (!ok)
+    {
+        free(sprite->pixels);
+        sprite->pixels = NULL;
+    }
+    return (ok);
+}
+
+static long align_up(long offset)
+{
+    return ((offset + ATLAS_ALIGN - 1) / ATLAS_ALIGN * ATLAS_ALIGN);
+}
+
+// Pack decoded sprites into an atlas file. Returns 0 on failure.
+int atlas_write(const char *path, const t_atlas_sprite *sprites, int count)
+{
+    char name[ATLAS_NAME_MAX];
+    long offset, size;
+    FILE *file;
+    int i, ok;
+
+    file = fopen(path, "wb");
+    if (!file)
+        return (0);
+    fwrite("SLAT", 1, 4, file);
+    put_u16(file, ATLAS_VERSION);
+    put_u16(file, count);
+    put_u64(file, 0);
+    offset = align_up(ATLAS_HEADER_SIZE + (long)count * ATLAS_ENTRY_SIZE);
+    for (i = 0; i < count; i++)
+    {
+        memset(name, 0, sizeof(name));
+        strncpy(name, sprites[i].name, ATLAS_NAME_MAX - 1);
+        fwrite(name, 1, sizeof(name), file);
+        put_u32(file, sprites[i].width);
+        put_u32(file, sprites[i].height);
+        put_u64(file, offset);
+        offset = align_up(offset + (long)sprites[i].width * sprites[i].height * 4);
+    }
+    for (i = 0; i < count; i++)
+    {
+        size = (long)sprites[i].width * sprites[i].height * 4;
+        while (ftell(file) % ATLAS_ALIGN)
+            fputc(0, file);
+        fwrite(sprites[i].pixels, 1, size, file);
+    }
+    ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    return (ok);
+}
+
+// Map an atlas and check its index, so that atlas_find never points outside
+// the file. Returns 0 if it is missing or malformed.
+int atlas_open(t_atlas *atlas, const char *path)
+{
+    const unsigned char *entry;
+    unsigned long long offset;
+    unsigned int width, height;
+    struct stat st;
+    int fd, i;
+
+    memset(atlas, 0, sizeof(*atlas));
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return (0);
+    if (fstat(fd, &st) == 0 && st.st_size >= ATLAS_HEADER_SIZE)
+    {
+        atlas->data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (atlas->data == MAP_FAILED)
+            atlas->data = NULL;
+        atlas->length = st.st_size;
+    }
+    close(fd);
+    if (!atlas->data)
+        return (0);
+    atlas->count = atlas->data[6] | (atlas->data[7] << 8);
+    if (memcmp(atlas->data, "SLAT", 4) != 0
+        || (atlas->data[4] | (atlas->data[5] << 8)) != ATLAS_VERSION
+        || ATLAS_HEADER_SIZE + (long)atlas->count * ATLAS_ENTRY_SIZE > atlas->length)
+    {
+        atlas_close(atlas);
+        return (0);
+    }
+    for (i = 0; i < atlas->count; i++)
+    {
+        entry = atlas->data + ATLAS_HEADER_SIZE + (long)i * ATLAS_ENTRY_SIZE;
+        width = get_u32(entry + ATLAS_NAME_MAX);
+        height = get_u32(entry + ATLAS_NAME_MAX + 4);
+        offset = get_u64(entry + ATLAS_NAME_MAX + 8);
+        if (!memchr(entry, '\0', ATLAS_NAME_MAX)
+            || width == 0 || width > ATLAS_MAX_SIDE || height == 0 || height > ATLAS_MAX_SIDE
+            || offset % ATLAS_ALIGN != 0
+            || offset + (unsigned long long)width * height * 4 > (unsigned long long)atlas->length)
+        {
+            atlas_close(atlas);
+            return (0);
+        }
+    }
+    return (1);
+}
+
+// Look a sprite up by name; its pixels point into the mapping and stay valid
+// until atlas_close. Returns 0 if the atlas has no such sprite.
+int atlas_find(const t_atlas *atlas, const char *name, t_atlas_sprite *sprite)
+{
+    const unsigned char *entry;
+    int i;
+
+    for (i = 0; i < atlas->count; i++)
+    {
+        entry = atlas->data + ATLAS_HEADER_SIZE + (long)i * ATLAS_ENTRY_SIZE;
+        if (strcmp((const char *)entry, name) != 0)
+            continue;
+        memcpy(sprite->name, entry, ATLAS_NAME_MAX);
+        sprite->width = get_u32(entry + ATLAS_NAME_MAX);
+        sprite->height = get_u32(entry + ATLAS_NAME_MAX + 4);
+        sprite->pixels = (unsigned int *)(atlas->data + get_u64(entry + ATLAS_NAME_MAX + 8));
+        return (1);
+    }
+    return (0);
+}
+
+void atlas_close(t_atlas *atlas)
+{
+    if (atlas->data)
+        munmap(atlas->data, atlas->length);
+    atlas->data = NULL;
+    atlas->count = 0;
+}
@@ -0,0 +1,44 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+// Sprite atlas: every sprite's pixels in one file, packed at build time by
+// tools/atlas_pack.c and mapped read-only by the game. An atlas file is:
+//   "SLAT" | version (u16) | count (u16) | reserved (u64)
+// then `count` index entries:
+//   name (ATLAS_NAME_MAX bytes, NUL padded) | width (u32) | height (u32) |
+//   offset of the pixels from the start of the file (u64)
+// then the pixels of each sprite, row after row without padding, each sprite
+// starting on an ATLAS_ALIGN boundary.
+// Pixels are 32-bit BGRA as MiniLibX keeps them in memory, alpha byte 0xFF
+// for "None", so building an image is a row copy. Everything is little-endian.
+// Headless like map.c: errors are returned, never printed.
+
+#define ATLAS_VERSION 1
+#define ATLAS_NAME_MAX 32
+#define ATLAS_HEADER_SIZE 16
+#define ATLAS_ENTRY_SIZE (ATLAS_NAME_MAX + 16)
+#define ATLAS_ALIGN 64
+#define ATLAS_MAX_SIDE 4096     // Largest sprite width or height accepted
+
+typedef struct s_atlas_sprite
+{
+    char            name[ATLAS_NAME_MAX];   // File name without directory and extension
+    int             width;
+    int             height;
+    unsigned int    *pixels;    // width * height pixels, row after row
+} t_atlas_sprite;
+
+typedef struct s_atlas
+{
+    unsigned char   *data;      // Whole file, mapped read-only
+    long            length;
+    int             count;
+} t_atlas;
+
+int     xpm_decode(const char *path, t_atlas_sprite *sprite);
+int     atlas_write(const char *path, const t_atlas_sprite *sprites, int count);
+int     atlas_open(t_atlas *atlas, const char *path);
+int     atlas_find(const t_atlas *atlas, const char *name, t_atlas_sprite *sprite);
+void    atlas_close(t_atlas *atlas);
+
+#endif
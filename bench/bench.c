@@ -0,0 +1,449 @@
+#include "../so_long.h"
+
+// Microbenchmarks for the hot paths of the game, run against the headless MLX
+// in bench/mlx_stub.c. One JSON object per line on stdout:
+//   {"bench":..., "map":..., "size":"WxH", "iterations":N, "ns_per_op":...,
+//    "p50_ns":..., "p95_ns":..., "p99_ns":..., "allocs_per_op":...,
+//    "mlx_calls_per_op":...}
+// The game's own logging is sent to /dev/null while the benches run.
+
+#define BENCH_SAMPLES 200
+#define BENCH_MIN_BATCH_NS 20000LL      // Calibrated batch length per sample
+#define BENCH_BUDGET_NS 500000000LL     // Stop sampling a bench after this long
+#define BENCH_MIN_SAMPLES 5
+#define BENCH_CROWD 4096                // Enemies in the crowded AI bench
+#define BENCH_CROWD_MIN_CELLS 250000    // Smallest map it runs on
+
+extern unsigned long g_mlx_calls;
+
+// Allocation counters, fed by the --wrap'd allocator entry points.
+// Allocations made inside libc itself (stdio buffers, strdup) are not seen.
+static unsigned long g_allocs = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    g_allocs++;
+    return (__real_malloc(size));
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    g_allocs++;
+    return (__real_calloc(count, size));
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    g_allocs++;
+    return (__real_realloc(ptr, size));
+}
+
+typedef struct s_bench_map
+{
+    char    *label;     // Name printed in the report
+    char    *path;      // File loaded by load_map
+    int     generated;  // 1 if path is a temporary file to remove afterwards
+} t_bench_map;
+
+typedef struct s_bench_ctx
+{
+    t_game      game;
+    t_bench_map *map;
+    int         enemy_x[BENCH_CROWD];   // Spawn state restored before each AI step
+    int         enemy_y[BENCH_CROWD];
+    int         enemy_count;
+    FILE        *out;                   // Report stream (the real stdout)
+    char        berc_path[64];          // Compiled copy of the current map
+} t_bench_ctx;
+
+typedef void (*t_bench_op)(t_bench_ctx *ctx);
+
+static int compare_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+
+    return ((x > y) - (x < y));
+}
+
+static long long percentile(long long *sorted, int count, int pct)
+{
+    int index = (count * pct + 99) / 100 - 1;
+
+    if (index < 0)
+        index = 0;
+    return (sorted[index]);
+}
+
+static void run_bench(t_bench_ctx *ctx, char *name, t_bench_op op)
+{
+    long long samples[BENCH_SAMPLES];
+    long long start, elapsed, total_ns = 0, began;
+    unsigned long allocs, mlx_calls;
+    long long iterations = 0;
+    int batch = 1;
+    int count = 0;
+    int i;
+
+    // Grow the batch until one sample is long enough to time reliably
+    for (;;)
+    {
+        start = monotonic_ns();
+        for (i = 0; i < batch; i++)
+            op(ctx);
+        elapsed = monotonic_ns() - start;
+        if (elapsed >= BENCH_MIN_BATCH_NS || batch >= (1 << 20))
+            break;
+        batch *= 2;
+    }
+
+    allocs = g_allocs;
+    mlx_calls = g_mlx_calls;
+    began = monotonic_ns();
+    while (count < BENCH_SAMPLES)
+    {
+        start = monotonic_ns();
+        for (i = 0; i < batch; i++)
+            op(ctx);
+        elapsed = monotonic_ns() - start;
+        samples[count++] = elapsed / batch;
+        total_ns += elapsed;
+        iterations += batch;
+        if (count >= BENCH_MIN_SAMPLES && start + elapsed - began > BENCH_BUDGET_NS)
+            break;
+    }
+    allocs = g_allocs - allocs;
+    mlx_calls = g_mlx_calls - mlx_calls;
+
+    qsort(samples, count, sizeof(long long), compare_ll);
+    fprintf(ctx->out, "{\"bench\":\"%s\",\"map\":\"%s\",\"size\":\"%dx%d\","
+            "\"iterations\":%lld,\"ns_per_op\":%.1f,"
+            "\"p50_ns\":%lld,\"p95_ns\":%lld,\"p99_ns\":%lld,"
+            "\"allocs_per_op\":%.3f,\"mlx_calls_per_op\":%.3f}\n",
+            name, ctx->map->label, ctx->game.sim.map_width, ctx->game.sim.map_height,
+            iterations, (double)total_ns / iterations,
+            percentile(samples, count, 50), percentile(samples, count, 95),
+            percentile(samples, count, 99),
+            (double)allocs / iterations, (double)mlx_calls / iterations);
+    fflush(ctx->out);
+}
+
+static void op_load_map(t_bench_ctx *ctx)
+{
+    load_map(&ctx->game, ctx->map->path);
+}
+
+static void op_load_map_berc(t_bench_ctx *ctx)
+{
+    load_map(&ctx->game, ctx->berc_path);
+}
+
+static void op_validate_map(t_bench_ctx *ctx)
+{
+    validate_map(&ctx->game);
+}
+
+static void op_flood_fill(t_bench_ctx *ctx)
+{
+    flood_fill_check(&ctx->game);
+}
+
+static void op_reach_scanline(t_bench_ctx *ctx)
+{
+    t_reach miss;
+
+    reach_scanline(&ctx->game.sim, &ctx->game.layout, &miss);
+}
+
+static void op_reach_parallel(t_bench_ctx *ctx)
+{
+    t_reach miss;
+
+    reach_parallel(&ctx->game.sim, &ctx->game.layout, &ctx->game.pool, &miss);
+}
+
+static void op_spawn_enemies(t_bench_ctx *ctx)
+{
+    sim_spawn_enemies(&ctx->game.sim, ENEMY_COUNT, ENEMY_SPAWN_DISTANCE);
+}
+
+static void save_enemies(t_bench_ctx *ctx)
+{
+    t_enemies *e = &ctx->game.sim.enemies;
+
+    ctx->enemy_count = e->count < BENCH_CROWD ? e->count : BENCH_CROWD;
+    memcpy(ctx->enemy_x, e->x, ctx->enemy_count * sizeof(int));
+    memcpy(ctx->enemy_y, e->y, ctx->enemy_count * sizeof(int));
+}
+
+static void restore_enemies(t_bench_ctx *ctx)
+{
+    int i;
+
+    sim_clear_enemies(&ctx->game.sim);
+    for (i = 0; i < ctx->enemy_count; i++)
+        sim_add_enemy(&ctx->game.sim, ctx->enemy_x[i], ctx->enemy_y[i], i % 3);
+}
+
+static void op_move_enemies(t_bench_ctx *ctx)
+{
+    restore_enemies(ctx);
+    sim_move_enemies(&ctx->game.sim);
+}
+
+static void op_render_full(t_bench_ctx *ctx)
+{
+    mark_full_redraw(&ctx->game);
+    render_game(&ctx->game);
+}
+
+// The camera is one tile off: follow_player scrolls it back, which rebakes
+// the static layer and repaints the whole view
+static void op_render_scroll(t_bench_ctx *ctx)
+{
+    ctx->game.cam_x = 1;
+    render_game(&ctx->game);
+}
+
+// A typical frame after a move: the player and enemy tiles are damaged
+static void op_render_dirty(t_bench_ctx *ctx)
+{
+    int i;
+
+    mark_entity_dirty(&ctx->game, ctx->game.sim.player_x, ctx->game.sim.player_y);
+    for (i = 0; i < ctx->game.sim.enemies.count; i++)
+        if (ctx->game.sim.enemies.active[i])
+            mark_entity_dirty(&ctx->game, ctx->game.sim.enemies.x[i], ctx->game.sim.enemies.y[i]);
+    render_game(&ctx->game);
+}
+
+// Reloads every sprite, replacing the ones loaded by main
+static void op_load_sprite_atlas(t_bench_ctx *ctx)
+{
+    destroy_sprites(&ctx->game);
+    load_sprite_atlas(&ctx->game, SPRITE_ATLAS);
+}
+
+static void op_decode_sprites(t_bench_ctx *ctx)
+{
+    destroy_sprites(&ctx->game);
+    decode_sprites(&ctx->game);
+}
+
+// Writes a walled map with a grid of pillars, P and E in opposite corners
+// and collectibles scattered over the floor. Returns 0 on failure.
+static int generate_map(t_bench_map *map, int width, int height)
+{
+    char path[] = "/tmp/so_long_bench_XXXXXX.ber";
+    char *row;
+    int fd, x, y, ok = 1;
+
+    fd = mkstemps(path, 4);
+    if (fd < 0)
+        return (0);
+    row = malloc(width + 1);
+    if (!row)
+    {
+        close(fd);
+        return (0);
+    }
+    for (y = 0; y < height && ok; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            if (x == 0 || y == 0 || x == width - 1 || y == height - 1)
+                row[x] = '1';
+            else if (x == 1 && y == 1)
+                row[x] = 'P';
+            else if (x == width - 2 && y == height - 2)
+                row[x] = 'E';
+            else if (x % 4 == 2 && y % 4 == 2)
+                row[x] = '1';
+            else if ((x * 7 + y * 13) % 37 == 0 || (x == width - 2 && y == 1))
+                row[x] = 'C';
+            else
+                row[x] = '0';
+        }
+        row[width] = '\n';
+        ok = write(fd, row, width + 1) == width + 1;
+    }
+    free(row);
+    close(fd);
+    map->path = strdup(path);
+    map->label = malloc(32);
+    if (!ok || !map->path || !map->label)
+        return (0);
+    snprintf(map->label, 32, "generated_%dx%d", width, height);
+    map->generated = 1;
+    return (1);
+}
+
+// Both reachability engines must give the same answer on every map
+static void check_reach_engines(t_bench_ctx *ctx)
+{
+    t_reach miss_a = {-1, -1}, miss_b = {-1, -1};
+    int a, b;
+
+    a = reach_scanline(&ctx->game.sim, &ctx->game.layout, &miss_a);
+    b = reach_parallel(&ctx->game.sim, &ctx->game.layout, &ctx->game.pool, &miss_b);
+    if (a != b || miss_a.x != miss_b.x || miss_a.y != miss_b.y)
+        fprintf(stderr, "bench: reach engines disagree on %s (%d vs %d)\n",
+                ctx->map->label, a, b);
+}
+
+// The frame is sized to the view, so every map gets a window
+static int setup_level(t_bench_ctx *ctx)
+{
+    t_game *game = &ctx->game;
+
+    game->window = NULL;
+    if (!load_map(game, ctx->map->path))
+        return (0);
+    sim_seed(&game->sim, 42);
+    reset_camera(game);
+    game->window = mlx_new_window(game->mlx, game->view_w * TILE_SIZE,
+                                  game->view_h * TILE_SIZE, "bench");
+    if (!game->window || !create_frame(game))
+        return (0);
+    bake_static_layer(game);
+    return (1);
+}
+
+static void teardown_level(t_bench_ctx *ctx)
+{
+    if (!ctx->game.window)
+        return;
+    destroy_image(&ctx->game, &ctx->game.frame);
+    destroy_image(&ctx->game, &ctx->game.static_layer);
+    mlx_destroy_window(ctx->game.mlx, ctx->game.window);
+    ctx->game.window = NULL;
+}
+
+static void bench_map(t_bench_ctx *ctx)
+{
+    t_sim *sim = &ctx->game.sim;
+
+    if (!setup_level(ctx))
+    {
+        fprintf(stderr, "bench: cannot set up %s\n", ctx->map->label);
+        return;
+    }
+    run_bench(ctx, "load_map", op_load_map);
+
+    // Same level from a .berc; it loads the same grid back
+    snprintf(ctx->berc_path, sizeof(ctx->berc_path), "/tmp/so_long_bench_%d.berc", (int)getpid());
+    if (compile_map(&ctx->game, ctx->map->path, ctx->berc_path))
+        run_bench(ctx, "load_map_berc", op_load_map_berc);
+    else
+        fprintf(stderr, "bench: cannot compile %s\n", ctx->map->label);
+    if (!load_map(&ctx->game, ctx->map->path))
+        fprintf(stderr, "bench: cannot reload %s\n", ctx->map->label);
+    unlink(ctx->berc_path);
+
+    // validate_map expects the raw grid, with the player still on it
+    SIM_CELL(sim, sim->player_x, sim->player_y) = 'P';
+    run_bench(ctx, "validate_map", op_validate_map);
+    SIM_CELL(sim, sim->player_x, sim->player_y) = '0';
+
+    run_bench(ctx, "flood_fill_check", op_flood_fill);
+    check_reach_engines(ctx);
+    run_bench(ctx, "reach_scanline", op_reach_scanline);
+    run_bench(ctx, "reach_parallel", op_reach_parallel);
+    run_bench(ctx, "spawn_enemies", op_spawn_enemies);
+    save_enemies(ctx);
+    run_bench(ctx, "move_enemies", op_move_enemies);
+    if ((long)sim->map_width * sim->map_height >= BENCH_CROWD_MIN_CELLS)
+    {
+        sim_spawn_enemies(sim, BENCH_CROWD, ENEMY_SPAWN_DISTANCE);
+        save_enemies(ctx);
+        run_bench(ctx, "move_enemies_crowd", op_move_enemies);
+        sim_spawn_enemies(sim, ENEMY_COUNT, ENEMY_SPAWN_DISTANCE);
+        save_enemies(ctx);
+    }
+    restore_enemies(ctx);
+    if (ctx->game.window)
+    {
+        run_bench(ctx, "render_game_full", op_render_full);
+        run_bench(ctx, "render_game_dirty", op_render_dirty);
+        run_bench(ctx, "render_game_scroll", op_render_scroll);
+    }
+    teardown_level(ctx);
+}
+
+int main(int argc, char **argv)
+{
+    static t_bench_ctx ctx;
+    static const int sizes[][2] = {{32, 32}, {60, 60}, {1000, 1000}};
+    t_bench_map maps[8];
+    t_bench_map assets = {"assets", SPRITE_ATLAS, 0};
+    int map_count = 0;
+    int i, out_fd;
+
+    (void)argc;
+    (void)argv;
+    ctx.game.enemy_slide_px = TILE_SIZE; // Enemies drawn on their cells
+
+    // Keep the real stdout for the report and silence the game's logging
+    out_fd = dup(1);
+    ctx.out = fdopen(out_fd, "w");
+    if (out_fd < 0 || !ctx.out || !freopen("/dev/null", "w", stdout))
+    {
+        fprintf(stderr, "bench: cannot redirect output\n");
+        return (1);
+    }
+
+    for (i = 1; i <= 3; i++)
+    {
+        maps[map_count].path = malloc(16);
+        snprintf(maps[map_count].path, 16, "eval%d.ber", i);
+        maps[map_count].label = maps[map_count].path;
+        maps[map_count].generated = 0;
+        map_count++;
+    }
+    for (i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++)
+        if (generate_map(&maps[map_count], sizes[i][0], sizes[i][1]))
+            map_count++;
+
+    ctx.game.mlx = mlx_init();
+    init_blitter();
+    init_map_scanner();
+    pool_init(&ctx.game.pool, 0);
+    init_glyph_atlas();
+    if (!ctx.game.mlx || !load_sprites(&ctx.game))
+    {
+        fprintf(stderr, "bench: cannot load sprites\n");
+        return (1);
+    }
+    ctx.game.current_eval = 1;
+
+    // Asset loading, reported under the map name "assets"
+    ctx.map = &assets;
+    // The atlas probe replaces the sprites load_sprites made
+    destroy_sprites(&ctx.game);
+    if (load_sprite_atlas(&ctx.game, SPRITE_ATLAS))
+        run_bench(&ctx, "load_sprite_atlas", op_load_sprite_atlas);
+    else
+        fprintf(stderr, "bench: no sprite atlas, run make %s first\n", SPRITE_ATLAS);
+    run_bench(&ctx, "decode_sprites", op_decode_sprites);
+
+    for (i = 0; i < map_count; i++)
+    {
+        ctx.map = &maps[i];
+        bench_map(&ctx);
+        if (maps[i].generated)
+        {
+            unlink(maps[i].path);
+            free(maps[i].label);
+        }
+        free(maps[i].path);
+    }
+
+    destroy_sprites(&ctx.game);
+    destroy_texts(&ctx.game);
+    fclose(ctx.out);
+    return (0);
+}
@@ -0,0 +1,228 @@
+#include "minilibx-linux/mlx.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Headless MiniLibX for the bench harness: images are plain 32-bit buffers,
+// windows are dummies and every call is counted so the harness can report
+// MLX traffic per operation.
+
+#define XPM_MAX_COLORS 256
+#define XPM_LINE_MAX 4096
+
+typedef struct s_stub_image
+{
+    int             width;
+    int             height;
+    unsigned int    *pixels;
+} t_stub_image;
+
+unsigned long g_mlx_calls = 0;
+
+void *mlx_init()
+{
+    g_mlx_calls++;
+    return (malloc(1));
+}
+
+void *mlx_new_window(void *mlx_ptr, int size_x, int size_y, char *title)
+{
+    (void)mlx_ptr;
+    (void)size_x;
+    (void)size_y;
+    (void)title;
+    g_mlx_calls++;
+    return (malloc(1));
+}
+
+int mlx_destroy_window(void *mlx_ptr, void *win_ptr)
+{
+    (void)mlx_ptr;
+    g_mlx_calls++;
+    free(win_ptr);
+    return (0);
+}
+
+int mlx_destroy_display(void *mlx_ptr)
+{
+    (void)mlx_ptr;
+    g_mlx_calls++;
+    return (0);
+}
+
+void *mlx_new_image(void *mlx_ptr, int width, int height)
+{
+    t_stub_image *image;
+
+    (void)mlx_ptr;
+    g_mlx_calls++;
+    image = malloc(sizeof(t_stub_image));
+    if (!image)
+        return (NULL);
+    image->width = width;
+    image->height = height;
+    image->pixels = calloc((size_t)width * height, sizeof(unsigned int));
+    if (!image->pixels)
+    {
+        free(image);
+        return (NULL);
+    }
+    return (image);
+}
+
+// Reads the quoted strings of an XPM file; returns how many were found
+static int read_xpm_strings(FILE *file, char **lines, int max_lines)
+{
+    char buffer[XPM_LINE_MAX];
+    char *start, *end;
+    int count = 0;
+
+    while (count < max_lines && fgets(buffer, sizeof(buffer), file))
+    {
+        start = strchr(buffer, '"');
+        if (!start || !(end = strchr(start + 1, '"')))
+            continue;
+        *end = '\0';
+        lines[count++] = strdup(start + 1);
+    }
+    return (count);
+}
+
+// Same convention as MiniLibX: "None" becomes a pixel with a full alpha byte
+static unsigned int parse_xpm_color(char *spec)
+{
+    char *c = strstr(spec, " c ");
+
+    if (!c)
+        return (0);
+    c += 3;
+    while (*c == ' ' || *c == '\t')
+        c++;
+    if (*c == '#')
+        return ((unsigned int)strtoul(c + 1, NULL, 16) & 0xFFFFFF);
+    return (0xFF000000);
+}
+
+void *mlx_xpm_file_to_image(void *mlx_ptr, char *filename, int *width, int *height)
+{
+    char *lines[XPM_MAX_COLORS + 1024];
+    char keys[XPM_MAX_COLORS][4];
+    unsigned int colors[XPM_MAX_COLORS];
+    t_stub_image *image = NULL;
+    int count, w, h, ncolors, cpp;
+    int i, x, y, k;
+    FILE *file;
+
+    file = fopen(filename, "r");
+    if (!file)
+        return (NULL);
+    count = read_xpm_strings(file, lines, (int)(sizeof(lines) / sizeof(lines[0])));
+    fclose(file);
+    if (count > 0 && sscanf(lines[0], "%d %d %d %d", &w, &h, &ncolors, &cpp) == 4
+        && ncolors <= XPM_MAX_COLORS && cpp >= 1 && cpp <= 3
+        && count >= 1 + ncolors + h)
+    {
+        for (i = 0; i < ncolors; i++)
+        {
+            memcpy(keys[i], lines[1 + i], cpp);
+            colors[i] = parse_xpm_color(lines[1 + i] + cpp);
+        }
+        image = mlx_new_image(mlx_ptr, w, h);
+        g_mlx_calls--; // Counted once, as the XPM load
+        for (y = 0; image && y < h; y++)
+        {
+            char *row = lines[1 + ncolors + y];
+
+            for (x = 0; x < w && (int)strlen(row) >= (x + 1) * cpp; x++)
+                for (k = 0; k < ncolors; k++)
+                    if (memcmp(row + x * cpp, keys[k], cpp) == 0)
+                    {
+                        image->pixels[y * w + x] = colors[k];
+                        break;
+                    }
+        }
+        *width = w;
+        *height = h;
+    }
+    for (i = 0; i < count; i++)
+        free(lines[i]);
+    g_mlx_calls++;
+    return (image);
+}
+
+char *mlx_get_data_addr(void *img_ptr, int *bits_per_pixel, int *size_line, int *endian)
+{
+    t_stub_image *image = img_ptr;
+
+    g_mlx_calls++;
+    *bits_per_pixel = 32;
+    *size_line = image->width * 4;
+    *endian = 0;
+    return ((char *)image->pixels);
+}
+
+int mlx_destroy_image(void *mlx_ptr, void *img_ptr)
+{
+    t_stub_image *image = img_ptr;
+
+    (void)mlx_ptr;
+    g_mlx_calls++;
+    free(image->pixels);
+    free(image);
+    return (0);
+}
+
+int mlx_put_image_to_window(void *mlx_ptr, void *win_ptr, void *img_ptr, int x, int y)
+{
+    (void)mlx_ptr;
+    (void)win_ptr;
+    (void)img_ptr;
+    (void)x;
+    (void)y;
+    g_mlx_calls++;
+    return (0);
+}
+
+int mlx_key_hook(void *win_ptr, int (*funct_ptr)(), void *param)
+{
+    (void)win_ptr;
+    (void)funct_ptr;
+    (void)param;
+    g_mlx_calls++;
+    return (0);
+}
+
+int mlx_loop_hook(void *mlx_ptr, int (*funct_ptr)(), void *param)
+{
+    (void)mlx_ptr;
+    (void)funct_ptr;
+    (void)param;
+    g_mlx_calls++;
+    return (0);
+}
+
+int mlx_hook(void *win_ptr, int x_event, int x_mask, int (*funct)(), void *param)
+{
+    (void)win_ptr;
+    (void)x_event;
+    (void)x_mask;
+    (void)funct;
+    (void)param;
+    g_mlx_calls++;
+    return (0);
+}
+
+// The harness drives the game itself; there is no event loop to run
+int mlx_loop(void *mlx_ptr)
+{
+    (void)mlx_ptr;
+    g_mlx_calls++;
+    return (0);
+}
+
+int mlx_loop_end(void *mlx_ptr)
+{
+    (void)mlx_ptr;
+    g_mlx_calls++;
+    return (0);
+}
@@ -0,0 +1,378 @@
+#include "berc.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BERC_UNREACHABLE 0xFFFFFFFFu   // Distance of a target P cannot walk to
+
+static void put_u16(FILE *file, unsigned int value)
+{
+    fputc(value & 0xFF, file);
+    fputc((value >> 8) & 0xFF, file);
+}
+
+static void put_u32(FILE *file, unsigned int value)
+{
+    put_u16(file, value & 0xFFFF);
+    put_u16(file, value >> 16);
+}
+
+static void put_u64(FILE *file, unsigned long long value)
+{
+    put_u32(file, (unsigned int)value);
+    put_u32(file, (unsigned int)(value >> 32));
+}
+
+static void put_varint(FILE *file, unsigned int value)
+{
+    while (value >= 0x80)
+    {
+        fputc((int)((value & 0x7F) | 0x80), file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+static int varint_size(unsigned int value)
+{
+    int size = 1;
+
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        size++;
+    }
+    return (size);
+}
+
+static unsigned int get_u32(const unsigned char *p)
+{
+    return (p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24));
+}
+
+static unsigned long long get_u64(const unsigned char *p)
+{
+    return (get_u32(p) | ((unsigned long long)get_u32(p + 4) << 32));
+}
+
+// Cell `i` of the grid in reading order, without the padding
+static char cell_at(t_sim *sim, long i)
+{
+    return (SIM_CELL(sim, i % sim->map_width, i / sim->map_width));
+}
+
+// Shortest walk from P to every cell, in `dist` (width * height entries).
+// The exit stays locked until the last collectible, so it ends a walk but
+// never lies on one. Returns 0 if scratch memory ran out.
+static int walk_distances(t_sim *sim, const t_sim_layout *layout, unsigned int *dist)
+{
+    static const int dx[4] = {0, 0, -1, 1};
+    static const int dy[4] = {-1, 1, 0, 0};
+    t_arena_mark mark = arena_mark(&sim->arena);
+    long cells = (long)sim->map_width * sim->map_height;
+    int *queue;
+    long head = 0, tail = 0;
+    int x, y, nx, ny, d;
+
+    queue = arena_alloc(&sim->arena, cells * sizeof(int));
+    if (!queue)
+        return (0);
+    memset(dist, 0xFF, cells * sizeof(unsigned int));
+    dist[(long)layout->player_y * sim->map_width + layout->player_x] = 0;
+    queue[tail++] = layout->player_y * sim->map_width + layout->player_x;
+    while (head < tail)
+    {
+        x = queue[head] % sim->map_width;
+        y = queue[head++] / sim->map_width;
+        if (SIM_CELL(sim, x, y) == 'E')
+            continue;
+        for (d = 0; d < 4; d++)
+        {
+            nx = x + dx[d];
+            ny = y + dy[d];
+
+            // The wall border keeps nx, ny inside the grid
+            if (SIM_CELL(sim, nx, ny) == '1'
+                || dist[(long)ny * sim->map_width + nx] != BERC_UNREACHABLE)
+                continue;
+            dist[(long)ny * sim->map_width + nx] = dist[(long)y * sim->map_width + x] + 1;
+            queue[tail++] = ny * sim->map_width + nx;
+        }
+    }
+    arena_rewind(&sim->arena, mark);
+    return (1);
+}
+
+// Size of the grid as (run length, cell) pairs
+static long rle_size(t_sim *sim)
+{
+    long cells = (long)sim->map_width * sim->map_height;
+    long size = 0, i, run;
+
+    for (i = 0; i < cells; i += run)
+    {
+        for (run = 1; i + run < cells && cell_at(sim, i + run) == cell_at(sim, i); run++)
+            ;
+        size += varint_size(run) + 1;
+    }
+    return (size);
+}
+
+static void write_grid(FILE *file, t_sim *sim, int rle)
+{
+    long cells = (long)sim->map_width * sim->map_height;
+    long i, run;
+    int y;
+
+    if (!rle)
+    {
+        for (y = 0; y < sim->map_height; y++)
+            fwrite(&SIM_CELL(sim, 0, y), 1, sim->map_width, file);
+        return;
+    }
+    for (i = 0; i < cells; i += run)
+    {
+        for (run = 1; i + run < cells && cell_at(sim, i + run) == cell_at(sim, i); run++)
+            ;
+        put_varint(file, run);
+        fputc(cell_at(sim, i), file);
+    }
+}
+
+// Compile a level that passed map_parse and the reachability check, with the
+// player still on the grid. RLE is only used on sparse maps, where it shrinks
+// the grid at least eightfold, as decoding short runs is slower than copying
+// raw rows. The flags written go to `flags`. Returns 0 on failure.
+int berc_write(const char *path, t_sim *sim, const t_sim_layout *layout,
+               unsigned long long source_hash, int *flags)
+{
+    t_arena_mark mark = arena_mark(&sim->arena);
+    long cells = (long)sim->map_width * sim->map_height;
+    long grid_size, x, y;
+    unsigned int *dist;
+    FILE *file;
+    int ok;
+
+    dist = arena_alloc(&sim->arena, cells * sizeof(unsigned int));
+    if (!dist || !walk_distances(sim, layout, dist))
+    {
+        arena_rewind(&sim->arena, mark);
+        return (0);
+    }
+    grid_size = rle_size(sim);
+    *flags = grid_size * 8 <= cells ? BERC_RLE : 0;
+    if (!(*flags & BERC_RLE))
+        grid_size = cells;
+
+    file = fopen(path, "wb");
+    if (!file)
+    {
+        arena_rewind(&sim->arena, mark);
+        return (0);
+    }
+    fwrite("SLBC", 1, 4, file);
+    put_u16(file, BERC_VERSION);
+    put_u16(file, *flags);
+    put_u32(file, sim->map_width);
+    put_u32(file, sim->map_height);
+    put_u32(file, layout->player_x);
+    put_u32(file, layout->player_y);
+    put_u32(file, layout->exit_x);
+    put_u32(file, layout->exit_y);
+    put_u32(file, dist[(long)layout->exit_y * sim->map_width + layout->exit_x]);
+    put_u32(file, layout->collectibles);
+    put_u64(file, source_hash);
+    put_u64(file, (unsigned long long)layout->collectibles * 12 + grid_size);
+    put_u64(file, 0);
+
+    for (y = 0; y < sim->map_height; y++)
+        for (x = 0; x < sim->map_width; x++)
+            if (SIM_CELL(sim, x, y) == 'C')
+            {
+                put_u32(file, x);
+                put_u32(file, y);
+                put_u32(file, dist[y * sim->map_width + x]);
+            }
+    write_grid(file, sim, *flags & BERC_RLE);
+
+    ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    arena_rewind(&sim->arena, mark);
+    return (ok);
+}
+
+static int corrupt(t_map_error *err)
+{
+    err->code = MAP_ERR_COMPILED;
+    err->row = -1;
+    err->col = -1;
+    return (0);
+}
+
+// Expand (run length, cell) pairs into the grid; every cell must be covered
+// exactly once. The C cells written go to `found`. Returns 0 if the runs do
+// not add up.
+static int read_rle(t_sim *sim, const unsigned char *p, const unsigned char *end,
+                    long *found)
+{
+    long cells = (long)sim->map_width * sim->map_height;
+    unsigned long run;
+    long i = 0, n;
+    int shift, x = 0, y = 0;
+
+    while (p < end)
+    {
+        run = 0;
+        for (shift = 0; p < end && shift <= 28; shift += 7)
+        {
+            run |= (unsigned long)(*p & 0x7F) << shift;
+            if (!(*p++ & 0x80))
+                break;
+        }
+        if (p >= end || run == 0 || run > (unsigned long)(cells - i))
+            return (0);
+
+        // Runs may cross row ends: fill one row segment at a time
+        i += run;
+        if (*p == 'C')
+            *found += run;
+        while (run > 0)
+        {
+            n = sim->map_width - x < (long)run ? sim->map_width - x : (long)run;
+            memset(&SIM_CELL(sim, x, y), *p, n);
+            run -= n;
+            x += n;
+            if (x == sim->map_width)
+            {
+                x = 0;
+                y++;
+            }
+        }
+        p++;
+    }
+    return (i == cells);
+}
+
+// The collectible list must name each C cell of the grid once. Listed cells
+// are marked 'c' while checking, then turned back.
+static int check_collectibles(t_sim *sim, const unsigned char *list,
+                              unsigned int count)
+{
+    unsigned int i, x, y;
+    int ok = 1;
+
+    for (i = 0; i < count && ok; i++)
+    {
+        x = get_u32(list + (long)i * 12);
+        y = get_u32(list + (long)i * 12 + 4);
+        ok = x < (unsigned int)sim->map_width && y < (unsigned int)sim->map_height
+             && SIM_CELL(sim, x, y) == 'C';
+        if (ok)
+            SIM_CELL(sim, x, y) = 'c';
+    }
+    while (i-- > 0)
+    {
+        x = get_u32(list + (long)i * 12);
+        y = get_u32(list + (long)i * 12 + 4);
+        if (x < (unsigned int)sim->map_width && y < (unsigned int)sim->map_height
+            && SIM_CELL(sim, x, y) == 'c')
+            SIM_CELL(sim, x, y) = 'C';
+    }
+    return (ok);
+}
+
+// Load a compiled level from its bytes into `sim`'s arena (the previous level
+// in that arena is dropped). The grid, P/E/C and exit distance come straight
+// from the file; its structure, the P and E cells and the collectibles are
+// checked. Returns 0 and fills `err`.
+int berc_load(t_sim *sim, t_sim_layout *layout, const unsigned char *data,
+              long length, t_map_error *err)
+{
+    unsigned long long payload;
+    unsigned int width, height, collectibles, flags;
+    const unsigned char *grid;
+    long grid_size, found = 0, x;
+    int y;
+
+    if (length < BERC_HEADER_SIZE || memcmp(data, "SLBC", 4) != 0
+        || (data[4] | (data[5] << 8)) != BERC_VERSION)
+        return (corrupt(err));
+    flags = data[6] | (data[7] << 8);
+    width = get_u32(data + 8);
+    height = get_u32(data + 12);
+    collectibles = get_u32(data + 36);
+    payload = get_u64(data + 48);
+    if (width == 0 || height == 0 || width >= MAX_WIDTH || height >= MAX_HEIGHT
+        || payload != (unsigned long long)(length - BERC_HEADER_SIZE)
+        || collectibles > width * height
+        || (unsigned long long)collectibles * 12 > payload)
+        return (corrupt(err));
+
+    memset(layout, 0, sizeof(*layout));
+    layout->players = 1;
+    layout->exits = 1;
+    layout->collectibles = collectibles;
+    layout->player_x = get_u32(data + 16);
+    layout->player_y = get_u32(data + 20);
+    layout->exit_x = get_u32(data + 24);
+    layout->exit_y = get_u32(data + 28);
+    layout->exit_distance = (int)get_u32(data + 32);
+    layout->compiled = 1;
+    if ((unsigned int)layout->player_x >= width || (unsigned int)layout->player_y >= height
+        || (unsigned int)layout->exit_x >= width || (unsigned int)layout->exit_y >= height)
+        return (corrupt(err));
+
+    if (!sim_alloc_grid(sim, width, height))
+    {
+        err->code = MAP_ERR_MEMORY;
+        return (0);
+    }
+    grid = data + BERC_HEADER_SIZE + (long)collectibles * 12;
+    grid_size = data + length - grid;
+    if (flags & BERC_RLE)
+    {
+        if (!read_rle(sim, grid, grid + grid_size, &found))
+            return (corrupt(err));
+    }
+    else
+    {
+        if (grid_size != (long)width * height)
+            return (corrupt(err));
+        for (y = 0; y < (int)height; y++)
+        {
+            memcpy(&SIM_CELL(sim, 0, y), grid + (long)y * width, width);
+            for (x = 0; x < (long)width; x++)
+                found += grid[(long)y * width + x] == 'C';
+        }
+    }
+
+    // The header positions must name the grid's own P and E
+    if (SIM_CELL(sim, layout->player_x, layout->player_y) != 'P'
+        || SIM_CELL(sim, layout->exit_x, layout->exit_y) != 'E')
+        return (corrupt(err));
+
+    // The collectible count and list must match the grid's C cells
+    if (found != (long)collectibles
+        || !check_collectibles(sim, data + BERC_HEADER_SIZE, collectibles))
+        return (corrupt(err));
+    err->code = MAP_OK;
+    return (1);
+}
+
+// Hash of the .ber a compiled level was built from, so replays recorded on
+// either file match. Returns 0 if `path` is not a readable .berc.
+int berc_source_hash(const char *path, unsigned long long *hash)
+{
+    unsigned char header[BERC_HEADER_SIZE];
+    FILE *file;
+    int ok;
+
+    file = fopen(path, "rb");
+    if (!file)
+        return (0);
+    ok = fread(header, 1, sizeof(header), file) == sizeof(header)
+         && memcmp(header, "SLBC", 4) == 0;
+    fclose(file);
+    if (ok)
+        *hash = get_u64(header + 40);
+    return (ok);
+}
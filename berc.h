@@ -0,0 +1,33 @@
+#ifndef BERC_H
+#define BERC_H
+
+// Compiled levels (.berc), written by --compile from a valid .ber.
+// A .berc file is a fixed header followed by the payload:
+//   "SLBC" | version (u16) | flags (u16) | width (u32) | height (u32) |
+//   player x, y (u32) | exit x, y (u32) | exit distance (u32) |
+//   collectibles (u32) | source hash (u64) | payload size (u64) |
+//   reserved (u64)
+// Payload: one entry per collectible, in reading order:
+//   x (u32) | y (u32) | distance from the player (u32)
+// then the grid, row after row without newlines, either raw or, with
+// BERC_RLE, as (run length (LEB128) | cell byte) pairs.
+// Distances are shortest walks from P. The source hash is the FNV-1a of
+// the .ber text, the same value replays use to identify a map.
+// All fixed-size fields are little-endian.
+// The loader trusts the distances: the structure, the P/E positions and the
+// collectibles are checked against the grid, so that a damaged file cannot
+// make it read or write out of bounds or start an inconsistent level.
+
+#include "map.h"
+
+#define BERC_VERSION 1
+#define BERC_HEADER_SIZE 64
+#define BERC_RLE 1          // Grid is run-length encoded
+
+int berc_write(const char *path, t_sim *sim, const t_sim_layout *layout,
+               unsigned long long source_hash, int *flags);
+int berc_load(t_sim *sim, t_sim_layout *layout, const unsigned char *data,
+              long length, t_map_error *err);
+int berc_source_hash(const char *path, unsigned long long *hash);
+
+#endif
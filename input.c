@@ -0,0 +1,35 @@
+#include "input.h"
+
+// Queue a key. Returns 0 if the queue is full and the key was dropped.
+int input_push(t_input *input, int keycode)
+{
+    unsigned int tail = input->tail;
+
+    if (tail - __atomic_load_n(&input->head, __ATOMIC_ACQUIRE) == INPUT_QUEUE_SIZE)
+        return (0);
+    input->keys[tail % INPUT_QUEUE_SIZE] = keycode;
+    __atomic_store_n(&input->tail, tail + 1, __ATOMIC_RELEASE);
+    return (1);
+}
+
+// Pop every queued key into `keys` (INPUT_QUEUE_SIZE entries), oldest first.
+// A run of one key longer than INPUT_MAX_REPEAT is auto-repeat that piled up
+// behind a slow frame: it is cut short so the player stops when the key is
+// released instead of walking off the backlog. Returns the number of keys.
+int input_drain(t_input *input, int *keys)
+{
+    unsigned int head = input->head;
+    unsigned int tail = __atomic_load_n(&input->tail, __ATOMIC_ACQUIRE);
+    int count = 0, run = 0;
+    int key;
+
+    for (; head != tail; head++)
+    {
+        key = input->keys[head % INPUT_QUEUE_SIZE];
+        run = (count > 0 && keys[count - 1] == key) ? run + 1 : 1;
+        if (run <= INPUT_MAX_REPEAT)
+            keys[count++] = key;
+    }
+    __atomic_store_n(&input->head, head, __ATOMIC_RELEASE);
+    return (count);
+}
@@ -0,0 +1,23 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+// Key events waiting for the game loop. X callbacks push them as they
+// arrive and game_loop pops them in one batch per frame, so a burst of
+// auto-repeat is applied together and drawn once. One producer, one
+// consumer: each side only writes its own index and publishes it with
+// release/acquire ordering, so neither ever takes a lock.
+
+#define INPUT_QUEUE_SIZE 64     // Power of two; keys pushed on a full queue are dropped
+#define INPUT_MAX_REPEAT 3      // Same key applied at most this many times in a row per batch
+
+typedef struct s_input
+{
+    int             keys[INPUT_QUEUE_SIZE];
+    unsigned int    head;       // Next key to pop, written by the consumer
+    unsigned int    tail;       // Next free slot, written by the producer
+} t_input;
+
+int     input_push(t_input *input, int keycode);
+int     input_drain(t_input *input, int *keys);
+
+#endif
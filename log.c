@@ -0,0 +1,241 @@
+#include "log.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+typedef struct s_log_slot
+{
+    unsigned int    seq;        // Ring position the slot is free (pos) or full (pos + 1) for
+    int             level;
+    long long       time_ns;
+    char            text[LOG_LINE_MAX];
+} t_log_slot;
+
+static struct
+{
+    t_log_slot      slots[LOG_SLOTS];
+    unsigned int    tail;       // Next position to claim, shared by the producers
+    unsigned int    head;       // Next position to write out, writer thread only
+    unsigned int    dropped;
+    unsigned int    wake;       // Futex word, bumped to wake the writer
+    int             parked;     // Writer is (about to be) waiting on `wake`
+    int             min_level;
+    int             json;
+    int             running;
+    int             stop;
+    long long       start_ns;
+    pthread_t       thread;
+} g_log;
+
+static const char *g_level_names[] = {"info", "warn", "error", "always"};
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((long long)ts.tv_sec * 1000000000LL + ts.tv_nsec);
+}
+
+static void futex_wait(unsigned int *word, unsigned int value, long timeout_ns)
+{
+    struct timespec timeout = {timeout_ns / 1000000000L, timeout_ns % 1000000000L};
+
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, &timeout, NULL, 0);
+}
+
+static void wake_writer(void)
+{
+    __atomic_fetch_add(&g_log.wake, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &g_log.wake, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+// One line as JSON: {"t_ms":..,"level":"..","msg":".."}. Blank lines used
+// as separators in plain output are not part of the message.
+static void write_json(FILE *out, const t_log_slot *slot)
+{
+    const unsigned char *p = (const unsigned char *)slot->text;
+    const unsigned char *end = p + strlen(slot->text);
+
+    while (p < end && *p == '\n')
+        p++;
+    while (end > p && end[-1] == '\n')
+        end--;
+    fprintf(out, "{\"t_ms\":%.3f,\"level\":\"%s\",\"msg\":\"",
+            (slot->time_ns - g_log.start_ns) / 1e6, g_level_names[slot->level]);
+    for (; p < end; p++)
+    {
+        if (*p == '"' || *p == '\\')
+            fprintf(out, "\\%c", *p);
+        else if (*p == '\n')
+            fputs("\\n", out);
+        else if (*p < 0x20)
+            fprintf(out, "\\u%04x", *p);
+        else
+            fputc(*p, out);
+    }
+    fputs("\"}\n", out);
+}
+
+static void write_line(FILE *out, const t_log_slot *slot)
+{
+    if (g_log.json)
+        write_json(out, slot);
+    else
+    {
+        fputs(slot->text, out);
+        fputc('\n', out);
+    }
+}
+
+// Sleep until a producer publishes into an empty ring or stops the writer.
+// `parked` is raised before the ring is checked again, and producers check
+// it after publishing, so a line is either seen here or wakes the futex;
+// the timeout only covers what a lost wake-up would leave behind.
+static void park_writer(t_log_slot *slot)
+{
+    unsigned int wake = __atomic_load_n(&g_log.wake, __ATOMIC_ACQUIRE);
+
+    __atomic_store_n(&g_log.parked, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != g_log.head + 1
+        && !__atomic_load_n(&g_log.stop, __ATOMIC_ACQUIRE))
+        futex_wait(&g_log.wake, wake, LOG_PARK_NS);
+    __atomic_store_n(&g_log.parked, 0, __ATOMIC_RELAXED);
+}
+
+// Writer thread: copy out every full slot, free it, and flush once the ring
+// is empty, so a burst of lines costs one write
+static void *log_writer(void *arg)
+{
+    t_log_slot *slot;
+
+    (void)arg;
+    for (;;)
+    {
+        slot = &g_log.slots[g_log.head % LOG_SLOTS];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == g_log.head + 1)
+        {
+            write_line(stdout, slot);
+            __atomic_store_n(&slot->seq, g_log.head + LOG_SLOTS, __ATOMIC_RELEASE);
+            g_log.head++;
+            continue;
+        }
+        fflush(stdout);
+        if (__atomic_load_n(&g_log.stop, __ATOMIC_ACQUIRE))
+        {
+            // Lines logged before the stop flag are in the ring by now
+            if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != g_log.head + 1)
+                break;
+            continue;
+        }
+        park_writer(slot);
+    }
+    return (NULL);
+}
+
+// Start the writer thread. `quiet` keeps only errors and LOG_ALWAYS lines,
+// `json` writes JSON lines. Lines are flushed at exit. Returns 0 if the
+// thread could not start; logging then stays synchronous.
+int log_init(int quiet, int json)
+{
+    unsigned int i;
+
+    g_log.min_level = quiet ? LOG_ERROR : LOG_INFO;
+    g_log.json = json;
+    g_log.start_ns = now_ns();
+    for (i = 0; i < LOG_SLOTS; i++)
+        g_log.slots[i].seq = i;
+    if (pthread_create(&g_log.thread, NULL, log_writer, NULL) != 0)
+        return (0);
+    g_log.running = 1;
+    atexit(log_shutdown);
+    return (1);
+}
+
+// Claim the next free slot and its ring position, or NULL if the ring is
+// full and the line may be dropped
+static t_log_slot *claim_slot(int level, unsigned int *claimed)
+{
+    unsigned int pos = __atomic_load_n(&g_log.tail, __ATOMIC_RELAXED);
+    t_log_slot *slot;
+    int diff;
+
+    for (;;)
+    {
+        slot = &g_log.slots[pos % LOG_SLOTS];
+        diff = (int)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&g_log.tail, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                *claimed = pos;
+                return (slot);
+            }
+        }
+        else if (diff < 0)
+        {
+            if (level != LOG_ALWAYS)
+            {
+                __atomic_fetch_add(&g_log.dropped, 1, __ATOMIC_RELAXED);
+                return (NULL);
+            }
+            sched_yield();
+            pos = __atomic_load_n(&g_log.tail, __ATOMIC_RELAXED);
+        }
+        else
+            pos = __atomic_load_n(&g_log.tail, __ATOMIC_RELAXED);
+    }
+}
+
+void log_print(int level, const char *format, ...)
+{
+    t_log_slot local;
+    t_log_slot *slot = &local;
+    unsigned int pos = 0;
+    va_list args;
+
+    if (level < g_log.min_level)
+        return;
+    if (g_log.running && !(slot = claim_slot(level, &pos)))
+        return;
+    slot->level = level;
+    slot->time_ns = now_ns();
+    va_start(args, format);
+    vsnprintf(slot->text, LOG_LINE_MAX, format, args);
+    va_end(args);
+    if (slot != &local)
+    {
+        __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&g_log.parked, __ATOMIC_RELAXED))
+            wake_writer();
+    }
+    else
+        write_line(stdout, slot);
+}
+
+// Write out every line logged so far and stop the writer thread
+void log_shutdown(void)
+{
+    unsigned int dropped;
+
+    if (!g_log.running)
+        return;
+    __atomic_store_n(&g_log.stop, 1, __ATOMIC_RELEASE);
+    wake_writer();
+    pthread_join(g_log.thread, NULL);
+    g_log.running = 0;
+    dropped = __atomic_load_n(&g_log.dropped, __ATOMIC_RELAXED);
+    if (dropped)
+        fprintf(stderr, "%u log lines dropped, the log ring was full\n", dropped);
+    fflush(stdout);
+}
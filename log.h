@@ -0,0 +1,29 @@
+#ifndef LOG_H
+#define LOG_H
+
+// Leveled logging off the game thread. log_print formats the line into a
+// slot of a fixed ring and returns; a background thread drains the ring to
+// stdout in batches, one write per batch. Any thread may log: slots are
+// claimed with a compare-and-swap and handed over with release/acquire, so
+// no caller ever takes a lock or waits on the terminal. The writer parks on
+// a futex while the ring is empty and the first line after that wakes it.
+// When the ring is full, lines are dropped and counted, except LOG_ALWAYS
+// lines, which wait for a free slot: those are the ones the subject requires
+// (the move count), so they are never filtered nor lost.
+// Until log_init, and if the thread cannot start, lines are written in place.
+
+#define LOG_INFO    0
+#define LOG_WARN    1
+#define LOG_ERROR   2
+#define LOG_ALWAYS  3
+
+#define LOG_SLOTS 1024          // Power of two
+#define LOG_LINE_MAX 256        // Longer lines are truncated
+#define LOG_PARK_NS 1000000000L // Longest the writer stays parked without a wake-up
+
+int     log_init(int quiet, int json);
+void    log_print(int level, const char *format, ...)
+        __attribute__((format(printf, 2, 3)));
+void    log_shutdown(void);
+
+#endif
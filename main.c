@@ -0,0 +1,247 @@
+#include "so_long.h"
+
+// Replays identify a map by its text, so a compiled level hashes as the .ber
+// it was built from
+static int hash_map_file(char *path, unsigned long long *hash)
+{
+    int len = strlen(path);
+
+    if (len >= 5 && strcmp(path + len - 5, ".berc") == 0)
+        return (berc_source_hash(path, hash));
+    return (replay_hash_file(path, hash));
+}
+
+// --compile: no window, just the checks and the .berc next to the .ber
+static int run_compile(t_game *game, char *map_file)
+{
+    char output[PATH_MAX];
+    int ok;
+
+    memset(&game->sim, 0, sizeof(game->sim));
+    memset(&game->pool, 0, sizeof(game->pool));
+    init_map_scanner();
+    snprintf(output, sizeof(output), "%sc", map_file);
+    ok = strlen(map_file) < PATH_MAX - 1 && compile_map(game, map_file, output);
+    arena_destroy(&game->sim.arena);
+    pool_destroy(&game->pool);
+    return (ok ? 0 : 1);
+}
+
+int main(int argc, char **argv)
+{
+    t_game game;
+    t_options opts;
+
+    if (!parse_args(argc, argv, &opts))
+    {
+        printf("Usage: %s [--record <file> | --replay <file> [--realtime]] [--seed <n>]\n"
+               "       [--quiet] [--log-json] [--profile <file.csv>] <map_file.ber|.berc>\n"
+               "       %s --compile <map_file.ber>\n", argv[0], argv[0]);
+        return (1);
+    }
+
+    // Console output goes through the logger thread from here on
+    log_init(opts.quiet, opts.log_json);
+
+    // Validate file extension
+    if (!check_file_extension(opts.map_file))
+        fatal_error("File must have .ber or .berc extension");
+    if (opts.compile)
+        return (run_compile(&game, opts.map_file));
+
+    // Seed the simulation: replays reuse the recorded seed
+    memset(&game.replay, 0, sizeof(game.replay));
+    memset(&game.input, 0, sizeof(game.input));
+    memset(&game.sim, 0, sizeof(game.sim));
+    memset(&game.pool, 0, sizeof(game.pool));
+    memset(&game.prefetch, 0, sizeof(game.prefetch));
+    if (opts.replay_file)
+    {
+        unsigned long long map_hash;
+
+        if (!replay_load(&game.replay, opts.replay_file))
+            fatal_error("Cannot read replay file");
+        if (!hash_map_file(opts.map_file, &map_hash) || map_hash != game.replay.map_hash)
+            fatal_error("Replay was recorded on a different map");
+        game.replay.realtime = opts.realtime;
+        opts.seed = game.replay.seed;
+    }
+    else if (!opts.has_seed)
+        opts.seed = (unsigned long long)time(NULL) ^ ((unsigned long long)getpid() << 32);
+    sim_seed(&game.sim, opts.seed);
+    log_print(LOG_INFO, "🎲 Seed: %llu", opts.seed);
+
+    if (opts.record_file)
+    {
+        unsigned long long map_hash;
+
+        if (!hash_map_file(opts.map_file, &map_hash)
+            || !replay_start_record(&game.replay, opts.record_file, map_hash, opts.seed))
+            fatal_error("Cannot create replay file");
+        log_print(LOG_INFO, "⏺️  Recording input to %s", opts.record_file);
+    }
+
+    log_print(LOG_INFO, "🚀 Starting Escape from the Cluster...");
+
+    // Initialize MLX
+    game.mlx = mlx_init();
+    if (!game.mlx)
+    {
+        log_print(LOG_ERROR, "❌ Error: Failed to initialize MLX");
+        return (1);
+    }
+
+    log_print(LOG_INFO, "✅ MLX initialized");
+
+    // Initialize game state
+    game.player_anim_frame = 0;
+    game.collect_anim_timer = 0;
+    game.collect_anim_drawn = 0;
+    game.game_over = 0;
+    game.game_over_reason = 0;
+    game.ticks = 0;
+    game.tick_debt_ns = 0;
+    game.enemy_move_tick = 0;
+    game.enemy_slide_px = TILE_SIZE;
+    game.enemy_slide_drawn = 0;
+    memset(&game.prof, 0, sizeof(game.prof));
+    memset(game.prof_lines, 0, sizeof(game.prof_lines));
+    game.show_profile = 0;
+    game.prof_hud_age = 0;
+    game.profile_file = opts.profile_file;
+
+    // Initialize sprite and frame images to empty
+    memset(&game.sprites, 0, sizeof(game.sprites));
+    memset(&game.frame, 0, sizeof(game.frame));
+    memset(&game.static_layer, 0, sizeof(game.static_layer));
+    memset(game.texts, 0, sizeof(game.texts));
+    game.window = NULL;
+
+    // Load sprites first
+    init_blitter();
+    log_print(LOG_INFO, "⚡ Map scanner: %s", init_map_scanner());
+    init_glyph_atlas();
+    if (!load_sprites(&game))
+    {
+        log_print(LOG_ERROR, "❌ Error: Failed to load sprites");
+        return (1);
+    }
+
+    log_print(LOG_INFO, "✅ Sprites loaded");
+
+    // Initialize game state
+    game.sim.score = 0;
+    game.current_eval = 1;
+    game.victory = 0;
+
+    // Load map
+    if (!load_map(&game, opts.map_file))
+    {
+        log_print(LOG_ERROR, "❌ Error: Failed to load map");
+        return (1);
+    }
+
+    log_print(LOG_INFO, "✅ Map loaded successfully");
+
+    // Create window: the whole map, or a view that follows the player
+    reset_camera(&game);
+    game.window = mlx_new_window(game.mlx,
+                                game.view_w * TILE_SIZE,
+                                game.view_h * TILE_SIZE,
+                                "Escape from the Cluster");
+    if (!game.window)
+    {
+        log_print(LOG_ERROR, "❌ Error: Failed to create window");
+        return (1);
+    }
+
+    // Create the backbuffer every frame is composed into
+    if (!create_frame(&game))
+    {
+        log_print(LOG_ERROR, "❌ Error: Failed to create frame buffer");
+        return (1);
+    }
+    bake_static_layer(&game);
+
+    log_print(LOG_INFO, "✅ Window created");
+
+    log_print(LOG_INFO, "\n=== ESCAPE FROM THE CLUSTER ===");
+    log_print(LOG_INFO, "🎓 Eval %d/3 - 42 School Cluster", game.current_eval);
+    log_print(LOG_INFO, "📍 Map: %dx%d", game.sim.map_width, game.sim.map_height);
+    if (game.view_w < game.sim.map_width || game.view_h < game.sim.map_height)
+        log_print(LOG_INFO, "🎥 View: %dx%d tiles, following the peer", game.view_w, game.view_h);
+    log_print(LOG_INFO, "👤 Peer at: (%d,%d)", game.sim.player_x, game.sim.player_y);
+    log_print(LOG_INFO, "📚 Eval Requirements (C): %d", game.sim.collectibles);
+    log_print(LOG_INFO, "🎯 Goal: Pass all 3 Evals to escape the cluster!");
+    log_print(LOG_INFO, "🎮 Controls: WASD, P for the frame profiler | Progress: Eval1 → Eval2 → Eval3 → Victory!\n");
+
+    // Initialize enemies
+    spawn_enemies(&game);
+
+    // Set hooks
+    set_hooks(&game);
+    if (game.replay.mode == REPLAY_PLAY)
+    {
+        log_print(LOG_INFO, "▶️  Replaying %d keys from %s (%s)", game.replay.count, opts.replay_file,
+                            game.replay.realtime ? "real-time" : "max speed");
+    }
+    mlx_loop_hook(game.mlx, game_loop, &game);
+
+    log_print(LOG_INFO, "✅ Starting game loop...");
+
+    // Render initial state
+    mark_full_redraw(&game);
+    render_game(&game);
+
+    // Load the next level in the background while this one is played
+    prefetch_start(&game);
+
+    // Start event loop; game_loop paces frames from here
+    game.start_ns = monotonic_ns();
+    game.last_loop_ns = game.start_ns;
+    game.next_frame_ns = game.start_ns;
+    mlx_loop(game.mlx);
+
+    return (0);
+}
+
+// Flags may appear in any order; the single positional argument is the map
+int parse_args(int argc, char **argv, t_options *opts)
+{
+    int i;
+
+    memset(opts, 0, sizeof(*opts));
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            opts->record_file = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            opts->replay_file = argv[++i];
+        else if (strcmp(argv[i], "--realtime") == 0)
+            opts->realtime = 1;
+        else if (strcmp(argv[i], "--compile") == 0)
+            opts->compile = 1;
+        else if (strcmp(argv[i], "--quiet") == 0)
+            opts->quiet = 1;
+        else if (strcmp(argv[i], "--log-json") == 0)
+            opts->log_json = 1;
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            opts->profile_file = argv[++i];
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            opts->seed = strtoull(argv[++i], NULL, 10);
+            opts->has_seed = 1;
+        }
+        else if (argv[i][0] == '-' && argv[i][1] == '-')
+            return (0);
+        else if (opts->map_file)
+            return (0);
+        else
+            opts->map_file = argv[i];
+    }
+    if (!opts->map_file || (opts->record_file && opts->replay_file))
+        return (0);
+    if (opts->compile && (opts->record_file || opts->replay_file))
+        return (0);
+    return (1);
+}
@@ -0,0 +1,329 @@
+#include "map.h"
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+# define HAVE_X86_SIMD 1
+#endif
+
+// P/E/C seen while scanning one row
+typedef struct s_row_counts
+{
+    int players;
+    int exits;
+    int collectibles;
+    int player_col;     // Last P in the row, -1 if none
+    int exit_col;       // Last E in the row, -1 if none
+} t_row_counts;
+
+// Scan row[start..len): count P/E/C and return the column of the first cell
+// that is not allowed in this row, or -1. Border rows only allow '1' and 'E'.
+typedef int (*t_row_scanner)(const char *row, int start, int len, int border,
+                             t_row_counts *counts);
+
+static int scan_row_scalar(const char *row, int start, int len, int border,
+                           t_row_counts *counts)
+{
+    int i;
+
+    for (i = start; i < len; i++)
+    {
+        if (row[i] == '1')
+            continue;
+        if (row[i] == 'E')
+        {
+            counts->exits++;
+            counts->exit_col = i;
+            continue;
+        }
+        if (border)
+            return (i);
+        if (row[i] == 'C')
+            counts->collectibles++;
+        else if (row[i] == 'P')
+        {
+            counts->players++;
+            counts->player_col = i;
+        }
+        else if (row[i] != '0')
+            return (i);
+    }
+    return (-1);
+}
+
+#ifdef HAVE_X86_SIMD
+// One compare per allowed byte, one movemask each; the masks give the error
+// column (ctz), the counts (popcount) and the last P/E (highest set bit)
+__attribute__((target("sse2")))
+static int scan_row_sse2(const char *row, int start, int len, int border,
+                         t_row_counts *counts)
+{
+    const __m128i c0 = _mm_set1_epi8('0');
+    const __m128i c1 = _mm_set1_epi8('1');
+    const __m128i cc = _mm_set1_epi8('C');
+    const __m128i ce = _mm_set1_epi8('E');
+    const __m128i cp = _mm_set1_epi8('P');
+    unsigned int floor_mask = border ? 0 : 0xFFFF;
+    int i;
+
+    for (i = start; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(row + i));
+        unsigned int m0 = _mm_movemask_epi8(_mm_cmpeq_epi8(v, c0));
+        unsigned int m1 = _mm_movemask_epi8(_mm_cmpeq_epi8(v, c1));
+        unsigned int mc = _mm_movemask_epi8(_mm_cmpeq_epi8(v, cc));
+        unsigned int me = _mm_movemask_epi8(_mm_cmpeq_epi8(v, ce));
+        unsigned int mp = _mm_movemask_epi8(_mm_cmpeq_epi8(v, cp));
+        unsigned int bad = ~(m1 | me | ((m0 | mc | mp) & floor_mask)) & 0xFFFF;
+
+        if (bad)
+            return (i + __builtin_ctz(bad));
+        counts->players += __builtin_popcount(mp);
+        counts->exits += __builtin_popcount(me);
+        counts->collectibles += __builtin_popcount(mc);
+        if (mp)
+            counts->player_col = i + 31 - __builtin_clz(mp);
+        if (me)
+            counts->exit_col = i + 31 - __builtin_clz(me);
+    }
+    return (scan_row_scalar(row, i, len, border, counts));
+}
+
+__attribute__((target("avx2,popcnt")))
+static int scan_row_avx2(const char *row, int start, int len, int border,
+                         t_row_counts *counts)
+{
+    const __m256i c0 = _mm256_set1_epi8('0');
+    const __m256i c1 = _mm256_set1_epi8('1');
+    const __m256i cc = _mm256_set1_epi8('C');
+    const __m256i ce = _mm256_set1_epi8('E');
+    const __m256i cp = _mm256_set1_epi8('P');
+    unsigned int floor_mask = border ? 0 : 0xFFFFFFFFu;
+    int i;
+
+    for (i = start; i + 32 <= len; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(row + i));
+        unsigned int m0 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c0));
+        unsigned int m1 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c1));
+        unsigned int mc = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, cc));
+        unsigned int me = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, ce));
+        unsigned int mp = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, cp));
+        unsigned int bad = ~(m1 | me | ((m0 | mc | mp) & floor_mask));
+
+        if (bad)
+            return (i + __builtin_ctz(bad));
+        counts->players += __builtin_popcount(mp);
+        counts->exits += __builtin_popcount(me);
+        counts->collectibles += __builtin_popcount(mc);
+        if (mp)
+            counts->player_col = i + 31 - __builtin_clz(mp);
+        if (me)
+            counts->exit_col = i + 31 - __builtin_clz(me);
+    }
+    // The tail call below skips the compiler's own vzeroupper
+    _mm256_zeroupper();
+    return (scan_row_scalar(row, i, len, border, counts));
+}
+#endif
+
+static t_row_scanner g_scan_row = scan_row_scalar;
+
+// Pick the widest row scanner this CPU supports and return its name
+const char *init_map_scanner(void)
+{
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+    {
+        g_scan_row = scan_row_avx2;
+        return ("AVX2");
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        g_scan_row = scan_row_sse2;
+        return ("SSE2");
+    }
+#endif
+    return ("scalar");
+}
+
+// Width is the first line; every row is that wide, so the file length alone
+// gives the height (the last newline is optional). Rows that disagree are
+// caught by map_parse.
+void map_measure(const char *text, long length, int *width, int *height)
+{
+    const char *end = memchr(text, '\n', length);
+    long w = end ? end - text : length;
+
+    *width = w;
+    *height = length / (w + 1) + (length % (w + 1) != 0);
+}
+
+// Bit i set where p[i] is `a` or `b`, for 64 bytes starting on a 16-byte boundary
+unsigned long map_mask64(const char *p, char a, char b)
+{
+#ifdef HAVE_X86_SIMD
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    unsigned long mask = 0;
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        __m128i v = _mm_load_si128((const __m128i *)(p + i * 16));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb));
+
+        mask |= (unsigned long)(unsigned int)_mm_movemask_epi8(hit) << (i * 16);
+    }
+    return (mask);
+#else
+    unsigned long mask = 0;
+    int i;
+
+    for (i = 0; i < 64; i++)
+        if (p[i] == a || p[i] == b)
+            mask |= 1UL << i;
+    return (mask);
+#endif
+}
+
+static int set_error(t_map_error *err, int code, int row, int col)
+{
+    err->code = code;
+    err->row = row;
+    err->col = col;
+    return (0);
+}
+
+// Validate one row of `len` readable cells out of `width` expected ones and
+// fold its counts into the layout. Returns 0 and fills `err` on failure.
+static int check_row(const char *row, int len, int width, int y, int height,
+                     t_sim_layout *layout, t_map_error *err)
+{
+    t_row_counts counts = {0, 0, 0, -1, -1};
+    int border = (y == 0 || y == height - 1);
+    int col;
+
+    if (width == 0)
+        return (set_error(err, MAP_ERR_RECT, y, 0));
+    col = g_scan_row(row, 0, len, border, &counts);
+    if (col >= 0)
+    {
+        if (row[col] == '\n')
+            return (set_error(err, MAP_ERR_RECT, y, col));
+        if (!strchr("01CEP", row[col]) || row[col] == '\0')
+            return (set_error(err, MAP_ERR_CHARSET, y, col));
+        return (set_error(err, MAP_ERR_BORDER, y, col));
+    }
+    if (len < width)
+        return (set_error(err, MAP_ERR_RECT, y, len));
+    if (row[0] != '1' && row[0] != 'E')
+        return (set_error(err, MAP_ERR_BORDER, y, 0));
+    if (row[width - 1] != '1' && row[width - 1] != 'E')
+        return (set_error(err, MAP_ERR_BORDER, y, width - 1));
+
+    layout->players += counts.players;
+    layout->exits += counts.exits;
+    layout->collectibles += counts.collectibles;
+    if (counts.player_col >= 0)
+    {
+        layout->player_x = counts.player_col;
+        layout->player_y = y;
+    }
+    if (counts.exit_col >= 0)
+    {
+        layout->exit_x = counts.exit_col;
+        layout->exit_y = y;
+    }
+    return (1);
+}
+
+static int check_counts(t_sim_layout *layout, t_map_error *err)
+{
+    if (layout->players != 1)
+    {
+        if (layout->players == 0)
+            return (set_error(err, MAP_ERR_PLAYER, -1, -1));
+        return (set_error(err, MAP_ERR_PLAYER, layout->player_y, layout->player_x));
+    }
+    if (layout->exits != 1)
+    {
+        if (layout->exits == 0)
+            return (set_error(err, MAP_ERR_EXIT, -1, -1));
+        return (set_error(err, MAP_ERR_EXIT, layout->exit_y, layout->exit_x));
+    }
+    if (layout->collectibles < 1)
+        return (set_error(err, MAP_ERR_COLLECTIBLE, -1, -1));
+    err->code = MAP_OK;
+    return (1);
+}
+
+// Fill the grid from `text` (sized by map_measure and sim_alloc_grid) and
+// validate it in the same pass. Returns 0 and fills `err` on the first error.
+int map_parse(t_sim *sim, const char *text, long length,
+              t_sim_layout *layout, t_map_error *err)
+{
+    const char *line;
+    long left;
+    int y, len;
+
+    memset(layout, 0, sizeof(*layout));
+    for (y = 0; y < sim->map_height; y++)
+    {
+        line = text + (long)y * (sim->map_width + 1);
+        left = text + length - line;
+        len = left < sim->map_width ? left : sim->map_width;
+        memcpy(&SIM_CELL(sim, 0, y), line, len);
+        if (!check_row(line, len, sim->map_width, y, sim->map_height, layout, err))
+            return (0);
+
+        // The row must end right here: newline, or end of file on the last row
+        if (left > sim->map_width && line[sim->map_width] != '\n')
+            return (set_error(err, MAP_ERR_RECT, y, sim->map_width));
+    }
+    return (check_counts(layout, err));
+}
+
+// Validate a grid that is already filled, as map_parse would have
+int map_validate(t_sim *sim, t_sim_layout *layout, t_map_error *err)
+{
+    int y;
+
+    memset(layout, 0, sizeof(*layout));
+    for (y = 0; y < sim->map_height; y++)
+        if (!check_row(&SIM_CELL(sim, 0, y), sim->map_width, sim->map_width,
+                       y, sim->map_height, layout, err))
+            return (0);
+    return (check_counts(layout, err));
+}
+
+const char *map_error_string(int code)
+{
+    if (code == MAP_ERR_CHARSET)
+        return ("Invalid character in map");
+    if (code == MAP_ERR_BORDER)
+        return ("Map must be surrounded by walls");
+    if (code == MAP_ERR_RECT)
+        return ("Map is not rectangular");
+    if (code == MAP_ERR_PLAYER)
+        return ("Map must have exactly one player");
+    if (code == MAP_ERR_EXIT)
+        return ("Map must have exactly one exit");
+    if (code == MAP_ERR_COLLECTIBLE)
+        return ("Map must have at least one collectible");
+    if (code == MAP_ERR_OPEN)
+        return ("Cannot open map file");
+    if (code == MAP_ERR_EMPTY)
+        return ("Cannot read map file or file is empty");
+    if (code == MAP_ERR_SIZE)
+        return ("Map too large");
+    if (code == MAP_ERR_MEMORY)
+        return ("Out of memory");
+    if (code == MAP_ERR_UNREACHABLE_C)
+        return ("Collectible not reachable from player position");
+    if (code == MAP_ERR_UNREACHABLE_E)
+        return ("Exit not reachable from player position");
+    if (code == MAP_ERR_COMPILED)
+        return ("Corrupt compiled level");
+    return ("No error");
+}
@@ -0,0 +1,41 @@
+#ifndef MAP_H
+#define MAP_H
+
+// Level file parsing: one pass that copies each text row into the sim grid
+// and validates it (charset, walled border, row length, P/E/C counts).
+// Headless like sim.c: errors are returned, never printed.
+
+#include "sim.h"
+
+// Error codes
+#define MAP_OK              0
+#define MAP_ERR_CHARSET     1   // Cell outside {0,1,C,E,P}
+#define MAP_ERR_BORDER      2   // Border cell that is neither wall nor exit
+#define MAP_ERR_RECT        3   // Row shorter or longer than the first one
+#define MAP_ERR_PLAYER      4   // Not exactly one P
+#define MAP_ERR_EXIT        5   // Not exactly one E
+#define MAP_ERR_COLLECTIBLE 6   // No C at all
+#define MAP_ERR_OPEN        7   // File cannot be opened
+#define MAP_ERR_EMPTY       8   // File cannot be read or is empty
+#define MAP_ERR_SIZE        9   // Larger than MAX_WIDTH x MAX_HEIGHT
+#define MAP_ERR_MEMORY      10  // Level arena allocation failed
+#define MAP_ERR_UNREACHABLE_C 11 // A C the player cannot walk to
+#define MAP_ERR_UNREACHABLE_E 12 // The E, likewise
+#define MAP_ERR_COMPILED    13  // Compiled level (.berc) with a broken structure
+
+typedef struct s_map_error
+{
+    int code;   // MAP_ERR_*
+    int row;    // 0-based position of the offending cell, -1 if none applies
+    int col;
+} t_map_error;
+
+const char  *init_map_scanner(void);
+unsigned long map_mask64(const char *p, char a, char b);
+void        map_measure(const char *text, long length, int *width, int *height);
+int         map_parse(t_sim *sim, const char *text, long length,
+                      t_sim_layout *layout, t_map_error *err);
+int         map_validate(t_sim *sim, t_sim_layout *layout, t_map_error *err);
+const char  *map_error_string(int code);
+
+#endif
@@ -0,0 +1,95 @@
+#include "pool.h"
+#include <unistd.h>
+
+// Hand out task indices until the job is drained. Called with the lock held.
+static void work(t_pool *pool)
+{
+    int task;
+
+    while (pool->next < pool->tasks)
+    {
+        task = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->fn(pool->ctx, task);
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->finished == pool->tasks)
+            pthread_cond_signal(&pool->done);
+    }
+}
+
+static void *worker(void *arg)
+{
+    t_pool *pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop)
+    {
+        work(pool);
+        if (!pool->stop)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return (NULL);
+}
+
+// Start `threads` - 1 workers (0 = one per online CPU). Returns 0 on failure.
+int pool_init(t_pool *pool, int threads)
+{
+    if (threads <= 0)
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > POOL_MAX_THREADS)
+        threads = POOL_MAX_THREADS;
+    pool->count = 0;
+    pool->tasks = 0;
+    pool->next = 0;
+    pool->finished = 0;
+    pool->stop = 0;
+    if (pthread_mutex_init(&pool->lock, NULL) != 0)
+        return (0);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->started = 1;
+    while (pool->count < threads - 1
+           && pthread_create(&pool->threads[pool->count], NULL, worker, pool) == 0)
+        pool->count++;
+    return (1);
+}
+
+// Threads that take part in a job, the caller included
+int pool_size(t_pool *pool)
+{
+    return (pool->count + 1);
+}
+
+void pool_run(t_pool *pool, t_pool_fn fn, void *ctx, int tasks)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->tasks = tasks;
+    pool->next = 0;
+    pool->finished = 0;
+    pthread_cond_broadcast(&pool->wake);
+    work(pool);
+    while (pool->finished < pool->tasks)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void pool_destroy(t_pool *pool)
+{
+    int i;
+
+    if (!pool->started)
+        return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (i = 0; i < pool->count; i++)
+        pthread_join(pool->threads[i], NULL);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    pthread_mutex_destroy(&pool->lock);
+    pool->started = 0;
+}
@@ -0,0 +1,35 @@
+#ifndef POOL_H
+#define POOL_H
+
+// Fixed set of worker threads for data-parallel jobs. pool_run splits a job
+// into `tasks` indices, the calling thread works alongside the workers, and
+// it returns once every task is done.
+
+#include <pthread.h>
+
+#define POOL_MAX_THREADS 64
+
+typedef void (*t_pool_fn)(void *ctx, int task);
+
+typedef struct s_pool
+{
+    pthread_t       threads[POOL_MAX_THREADS];
+    int             count;      // Workers started, the caller is not counted
+    int             started;
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;       // New tasks or shutdown
+    pthread_cond_t  done;       // Last task of the job finished
+    t_pool_fn       fn;
+    void            *ctx;
+    int             tasks;
+    int             next;       // Next task index to hand out
+    int             finished;
+    int             stop;
+} t_pool;
+
+int     pool_init(t_pool *pool, int threads);
+int     pool_size(t_pool *pool);
+void    pool_run(t_pool *pool, t_pool_fn fn, void *ctx, int tasks);
+void    pool_destroy(t_pool *pool);
+
+#endif
@@ -0,0 +1,110 @@
+#include "so_long.h"
+
+// Level file of each eval after the first, NULL past the last one
+char *eval_map_file(int eval)
+{
+    if (eval == 2)
+        return ("eval1.ber");
+    if (eval == 3)
+        return ("eval2.ber");
+    return (NULL);
+}
+
+// Background thread: everything load_map does, into the staging grid.
+// Compiled levels skip the reachability check, as in load_map.
+// Touches nothing the main thread uses except the pool, started beforehand
+// by prefetch_start; load_map joins this thread before using it.
+static void *prefetch_main(void *arg)
+{
+    t_game *game = arg;
+    t_prefetch *pf = &game->prefetch;
+    long long start = monotonic_ns();
+    t_map_error err;
+    t_reach miss;
+
+    pf->ready = read_level(&pf->sim, &pf->layout, &pf->dirty, pf->filename, &err)
+                && sim_init_level(&pf->sim, &pf->layout)
+                && sim_index_free_cells(&pf->sim)
+                && (pf->layout.compiled
+                    || level_reach(game, &pf->sim, &pf->layout, &miss) == 1);
+    pf->load_ns = monotonic_ns() - start;
+    return (NULL);
+}
+
+// Start loading the level after the current one, if there is one
+void prefetch_start(t_game *game)
+{
+    t_prefetch *pf = &game->prefetch;
+
+    prefetch_cancel(game);
+    pf->eval = game->current_eval + 1;
+    pf->filename = eval_map_file(pf->eval);
+    if (!pf->filename)
+        return;
+    pf->ready = 0;
+    start_pool(game);
+    pf->running = (pthread_create(&pf->thread, NULL, prefetch_main, game) == 0);
+}
+
+// Wait for the background load and drop its result
+void prefetch_cancel(t_game *game)
+{
+    if (game->prefetch.running)
+        pthread_join(game->prefetch.thread, NULL);
+    game->prefetch.running = 0;
+    game->prefetch.ready = 0;
+}
+
+// Make the level in the staging grid the live one. The old level's arena goes
+// to the staging side, to be reused by the next load. The thread must not be
+// running.
+void prefetch_swap(t_game *game)
+{
+    t_prefetch *pf = &game->prefetch;
+    t_arena old_arena = game->sim.arena;
+
+    game->sim.arena = pf->sim.arena;
+    game->sim.cells = pf->sim.cells;
+    game->sim.stride = pf->sim.stride;
+    game->sim.map_width = pf->sim.map_width;
+    game->sim.map_height = pf->sim.map_height;
+
+    // The rest of the level's buffers came with the arena
+    game->sim.flow = pf->sim.flow;
+    game->sim.flow_queue = pf->sim.flow_queue;
+    game->sim.flow_base = pf->sim.flow_base;
+    game->sim.free_rank = pf->sim.free_rank;
+    game->sim.free_count = pf->sim.free_count;
+    game->sim.occupancy = pf->sim.occupancy;
+    game->sim.enemies = pf->sim.enemies;
+    pf->sim.arena = old_arena;
+    pf->sim.cells = NULL;
+    game->layout = pf->layout;
+    game->dirty = pf->dirty;
+    game->dirty_count = 0;
+}
+
+// Swap the prefetched level in if it is `eval` and it loaded cleanly.
+// Returns 0 if the caller has to load the level itself.
+int prefetch_take(t_game *game, int eval)
+{
+    t_prefetch *pf = &game->prefetch;
+
+    if (pf->running)
+        pthread_join(pf->thread, NULL);
+    pf->running = 0;
+    if (!pf->ready || pf->eval != eval)
+        return (0);
+    pf->ready = 0;
+    prefetch_swap(game);
+
+    // Fresh counters; the player cell is already floor
+    sim_init_level(&game->sim, &game->layout);
+    return (1);
+}
+
+void prefetch_destroy(t_game *game)
+{
+    prefetch_cancel(game);
+    arena_destroy(&game->prefetch.sim.arena);
+}
@@ -0,0 +1,128 @@
+#include "profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *g_phase_names[PROF_PHASES] = {
+    "tiles", "player", "enemies", "labels", "collect", "ui", "menu", "present", "frame"
+};
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((long long)ts.tv_sec * 1000000000LL + ts.tv_nsec);
+}
+
+void prof_frame_begin(t_profile *prof)
+{
+    memset(prof->frame_ns, 0, sizeof(prof->frame_ns));
+    memset(prof->frame_mlx, 0, sizeof(prof->frame_mlx));
+    prof->timing = 0;
+    prof->frame_start_ns = now_ns();
+}
+
+void prof_begin(t_profile *prof, int phase)
+{
+    prof->phase = phase;
+    prof->timing = 1;
+    prof->phase_start_ns = now_ns();
+}
+
+// A phase may be entered several times a frame; its times add up
+void prof_end(t_profile *prof)
+{
+    if (!prof->timing)
+        return;
+    prof->frame_ns[prof->phase] += now_ns() - prof->phase_start_ns;
+    prof->timing = 0;
+}
+
+void prof_count_mlx(t_profile *prof)
+{
+    if (prof->timing)
+        prof->frame_mlx[prof->phase]++;
+    prof->frame_mlx[PROF_FRAME]++;
+}
+
+void prof_frame_end(t_profile *prof)
+{
+    int slot = prof->frames % PROF_WINDOW;
+    int i;
+
+    prof_end(prof);
+    prof->frame_ns[PROF_FRAME] = now_ns() - prof->frame_start_ns;
+    for (i = 0; i < PROF_PHASES; i++)
+    {
+        prof->window_ns[i][slot] = prof->frame_ns[i];
+        prof->window_mlx[i][slot] = prof->frame_mlx[i];
+        prof->total_ns[i] += prof->frame_ns[i];
+        prof->total_mlx[i] += prof->frame_mlx[i];
+    }
+    prof->frames++;
+}
+
+static int compare_ns(const void *a, const void *b)
+{
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+
+    return ((x > y) - (x < y));
+}
+
+// Percentiles of one phase over the frames in the window (nearest rank)
+void prof_stats(const t_profile *prof, int phase, t_prof_stats *stats)
+{
+    long long sorted[PROF_WINDOW];
+    long long mlx = 0;
+    int count = prof->frames < PROF_WINDOW ? (int)prof->frames : PROF_WINDOW;
+    int i;
+
+    memset(stats, 0, sizeof(*stats));
+    if (count == 0)
+        return;
+    for (i = 0; i < count; i++)
+    {
+        sorted[i] = prof->window_ns[phase][i];
+        mlx += prof->window_mlx[phase][i];
+    }
+    qsort(sorted, count, sizeof(sorted[0]), compare_ns);
+    stats->p50_ns = sorted[(count - 1) * 50 / 100];
+    stats->p95_ns = sorted[(count - 1) * 95 / 100];
+    stats->p99_ns = sorted[(count - 1) * 99 / 100];
+    stats->max_ns = sorted[count - 1];
+    stats->mlx_per_frame = (double)mlx / count;
+}
+
+const char *prof_phase_name(int phase)
+{
+    return (g_phase_names[phase]);
+}
+
+// One row per phase: totals since the start, percentiles over the last
+// PROF_WINDOW frames. Returns 0 if the file cannot be written.
+int prof_write_csv(const t_profile *prof, const char *path)
+{
+    t_prof_stats stats;
+    FILE *file;
+    int i, ok;
+
+    file = fopen(path, "w");
+    if (!file)
+        return (0);
+    fprintf(file, "phase,frames,total_ms,mean_us,p50_us,p95_us,p99_us,max_us,mlx_calls,mlx_per_frame\n");
+    for (i = 0; i < PROF_PHASES; i++)
+    {
+        prof_stats(prof, i, &stats);
+        fprintf(file, "%s,%lld,%.3f,%.2f,%.2f,%.2f,%.2f,%.2f,%lld,%.2f\n",
+                g_phase_names[i], prof->frames, prof->total_ns[i] / 1e6,
+                prof->frames ? prof->total_ns[i] / 1e3 / prof->frames : 0.0,
+                stats.p50_ns / 1e3, stats.p95_ns / 1e3, stats.p99_ns / 1e3,
+                stats.max_ns / 1e3, prof->total_mlx[i], stats.mlx_per_frame);
+    }
+    ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    return (ok);
+}
@@ -0,0 +1,57 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// Frame-time profiler. render_game brackets its frame with prof_frame_begin
+// and prof_frame_end and each phase inside it with prof_begin and prof_end;
+// MLX calls made during a phase are counted against it. The last PROF_WINDOW
+// frames are kept per phase for rolling percentiles, totals since the start
+// go to the CSV. Phases a frame skips count as zero for that frame.
+// Headless like sim.c.
+
+#define PROF_TILES      0   // Static layer copy and tile overlays
+#define PROF_PLAYER     1
+#define PROF_ENEMIES    2
+#define PROF_LABELS     3
+#define PROF_COLLECT    4   // Collect animation circle
+#define PROF_UI         5
+#define PROF_MENU       6   // Game over menu
+#define PROF_PRESENT    7   // Backbuffer to window
+#define PROF_FRAME      8   // Whole frame, overlay included
+#define PROF_PHASES     9
+
+#define PROF_WINDOW 256     // Frames the percentiles are taken over
+
+typedef struct s_prof_stats
+{
+    long long   p50_ns;
+    long long   p95_ns;
+    long long   p99_ns;
+    long long   max_ns;
+    double      mlx_per_frame;
+} t_prof_stats;
+
+typedef struct s_profile
+{
+    long long   window_ns[PROF_PHASES][PROF_WINDOW];    // Last frames, oldest overwritten
+    int         window_mlx[PROF_PHASES][PROF_WINDOW];
+    long long   frame_ns[PROF_PHASES];  // Frame being timed
+    int         frame_mlx[PROF_PHASES];
+    long long   total_ns[PROF_PHASES];  // Since the start
+    long long   total_mlx[PROF_PHASES];
+    long long   frames;
+    int         phase;
+    int         timing;                 // `phase` is being timed
+    long long   phase_start_ns;
+    long long   frame_start_ns;
+} t_profile;
+
+void        prof_frame_begin(t_profile *prof);
+void        prof_begin(t_profile *prof, int phase);
+void        prof_end(t_profile *prof);
+void        prof_count_mlx(t_profile *prof);
+void        prof_frame_end(t_profile *prof);
+void        prof_stats(const t_profile *prof, int phase, t_prof_stats *stats);
+const char  *prof_phase_name(int phase);
+int         prof_write_csv(const t_profile *prof, const char *path);
+
+#endif
@@ -0,0 +1,427 @@
+#include "reach.h"
+#include "map.h"
+#include <string.h>
+
+// Scanline flood fill over bitsets. Cells are addressed by their offset from
+// the grid's top-left border cell, so x = -1 and y = -1 stay non-negative.
+// The stride is a multiple of 64, so every grid row starts on a new word.
+typedef struct s_fill
+{
+    unsigned long   *blocked;   // Wall or already filled, one bit per grid byte
+    unsigned long   *targets;   // C and E cells
+    long            *stack;     // Seeds: one cell of a run not filled yet
+    long            top;
+    long            capacity;
+    int             remaining;  // C and E cells not reached yet
+} t_fill;
+
+static int fill_push(t_sim *sim, t_fill *fill, long cell)
+{
+    long *grown;
+
+    if (fill->top == fill->capacity)
+    {
+        // Rarely needed: the old block stays in the arena until the rewind
+        grown = arena_alloc(&sim->arena, fill->capacity * 2 * sizeof(long));
+        if (!grown)
+            return (0);
+        memcpy(grown, fill->stack, fill->top * sizeof(long));
+        fill->stack = grown;
+        fill->capacity *= 2;
+    }
+    fill->stack[fill->top++] = cell;
+    return (1);
+}
+
+// Bits [from, to] of word `w`, with from/to clamped to the word
+static unsigned long range_mask(long w, long from, long to)
+{
+    unsigned long mask = ~0UL;
+
+    if (from > w * 64)
+        mask &= ~0UL << (from & 63);
+    if (to < w * 64 + 63)
+        mask &= ~0UL >> (63 - (to & 63));
+    return (mask);
+}
+
+// Push the first cell of every open run in [from, to] (a row above or below
+// the run just filled). Open runs are either wholly filled or not at all.
+static int fill_seed_row(t_sim *sim, t_fill *fill, long from, long to)
+{
+    unsigned long free_bits, starts;
+    unsigned long carry = 0;
+    long w;
+
+    for (w = from >> 6; w <= to >> 6; w++)
+    {
+        free_bits = ~fill->blocked[w] & range_mask(w, from, to);
+        starts = free_bits & ~((free_bits << 1) | carry);
+        carry = free_bits >> 63;
+        while (starts)
+        {
+            if (!fill_push(sim, fill, w * 64 + __builtin_ctzl(starts)))
+                return (0);
+            starts &= starts - 1;
+        }
+    }
+    return (1);
+}
+
+// Fill whole horizontal runs from the player, seeding the rows above and
+// below each run. Runs and seeds are found a word at a time, and the wall
+// border stops them without bounds checks.
+// Stops as soon as every C and the E have been reached. Returns -1 if memory
+// runs out, else 1 when all targets were reached and 0 otherwise.
+static int flood_fill_walk(t_sim *sim, t_fill *fill)
+{
+    unsigned long bits, span;
+    long cell, left, right, w;
+
+    if (!fill_push(sim, fill, (long)(sim->player_y + 1) * sim->stride + sim->player_x))
+        return (-1);
+    while (fill->top > 0)
+    {
+        cell = fill->stack[--fill->top];
+        w = cell >> 6;
+        if ((fill->blocked[w] >> (cell & 63)) & 1)
+            continue;
+
+        // Nearest blocked cell on each side
+        bits = fill->blocked[w] & ~(~0UL << (cell & 63));
+        while (!bits)
+            bits = fill->blocked[--w];
+        left = w * 64 + 63 - __builtin_clzl(bits) + 1;
+        w = cell >> 6;
+        bits = fill->blocked[w] & (~0UL << (cell & 63));
+        while (!bits)
+            bits = fill->blocked[++w];
+        right = w * 64 + __builtin_ctzl(bits) - 1;
+
+        for (w = left >> 6; w <= right >> 6; w++)
+        {
+            span = range_mask(w, left, right);
+            fill->blocked[w] |= span;
+            fill->remaining -= __builtin_popcountl(fill->targets[w] & span);
+        }
+        if (fill->remaining == 0)
+            return (1);
+        if (!fill_seed_row(sim, fill, left - sim->stride, right - sim->stride)
+            || !fill_seed_row(sim, fill, left + sim->stride, right + sim->stride))
+            return (-1);
+    }
+    return (0);
+}
+
+// Walls and C/E as bitsets, then fill from the player
+int reach_scanline(t_sim *sim, const t_sim_layout *layout, t_reach *miss)
+{
+    t_arena_mark mark = arena_mark(&sim->arena);
+    const char *base = sim->cells - sim->stride;
+    long words = (long)(sim->map_height + 2) * sim->stride / 64;
+    unsigned long left_out;
+    t_fill fill;
+    int reached;
+    long w;
+
+    // Scratch bitsets and seed stack, released before returning. The stack
+    // starts at a few seeds per row and grows in the arena for mazes.
+    fill.capacity = 4L * (sim->map_height + 16);
+    fill.top = 0;
+    fill.remaining = layout->collectibles + layout->exits;
+    fill.blocked = arena_alloc(&sim->arena, words * sizeof(unsigned long));
+    fill.targets = arena_alloc(&sim->arena, words * sizeof(unsigned long));
+    fill.stack = arena_alloc(&sim->arena, fill.capacity * sizeof(long));
+    if (!fill.blocked || !fill.targets || !fill.stack)
+    {
+        arena_rewind(&sim->arena, mark);
+        return (-1);
+    }
+    for (w = 0; w < words; w++)
+    {
+        fill.blocked[w] = map_mask64(base + w * 64, '1', '1');
+        fill.targets[w] = map_mask64(base + w * 64, 'C', 'E');
+    }
+
+    reached = flood_fill_walk(sim, &fill);
+
+    // Something was left out: the first one in reading order
+    for (w = 0; reached == 0 && w < words; w++)
+    {
+        left_out = fill.targets[w] & ~fill.blocked[w];
+        if (!left_out)
+            continue;
+        miss->x = (w * 64 + __builtin_ctzl(left_out)) % sim->stride;
+        miss->y = (w * 64 + __builtin_ctzl(left_out)) / sim->stride - 1;
+        break;
+    }
+
+    arena_rewind(&sim->arena, mark);
+    return (reached);
+}
+
+// Parallel engine: the grid is cut into bands of rows. Each band turns its
+// rows into runs of open cells and unions the overlapping runs of adjacent
+// rows; then the runs on both sides of every band edge are unioned, all bands
+// at once. Runs are numbered row by row across the whole map.
+typedef struct s_label
+{
+    t_sim   *sim;
+    int     band_rows;
+    long    *row_first;     // Runs of row y are [row_first[y], row_first[y + 1])
+    int     *run_start;     // First open cell
+    int     *run_stop;      // First wall after the run
+    int     *run_targets;   // C and E cells in the run
+    int     *parent;        // Union-find forest over runs
+    int     root;           // Component of the player
+    long    reached;        // Targets found in the player's component
+} t_label;
+
+// Lock-free union-find: roots only ever get linked under a smaller index,
+// and path halving tolerates concurrent updates since it only ever points a
+// node at one of its ancestors.
+static int uf_find(int *parent, int i)
+{
+    int p, gp;
+
+    while (1)
+    {
+        p = __atomic_load_n(&parent[i], __ATOMIC_RELAXED);
+        if (p == i)
+            return (i);
+        gp = __atomic_load_n(&parent[p], __ATOMIC_RELAXED);
+        if (gp == p)
+            return (p);
+        __atomic_compare_exchange_n(&parent[i], &p, gp, 1,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        i = gp;
+    }
+}
+
+static void uf_union(int *parent, int a, int b)
+{
+    int tmp;
+
+    while (1)
+    {
+        a = uf_find(parent, a);
+        b = uf_find(parent, b);
+        if (a == b)
+            return;
+        if (a < b)
+        {
+            tmp = a;
+            a = b;
+            b = tmp;
+        }
+        tmp = a;
+        if (__atomic_compare_exchange_n(&parent[a], &tmp, b, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            return;
+    }
+}
+
+static const char *grid_row(t_sim *sim, int y)
+{
+    return (&SIM_CELL(sim, 0, y));
+}
+
+// Open cells that follow a wall (or the row start), per word
+#define RUN_STARTS(open, carry) ((open) & ~(((open) << 1) | (carry)))
+
+static void band_count(void *ctx, int band)
+{
+    t_label *label = ctx;
+    t_sim *sim = label->sim;
+    int y = band * label->band_rows;
+    int y1 = y + label->band_rows;
+    unsigned long open, carry;
+    long count;
+    int w;
+
+    if (y1 > sim->map_height)
+        y1 = sim->map_height;
+    for (; y < y1; y++)
+    {
+        count = 0;
+        carry = 0;
+        for (w = 0; w < sim->stride / 64; w++)
+        {
+            open = ~map_mask64(grid_row(sim, y) + w * 64, '1', '1');
+            count += __builtin_popcountl(RUN_STARTS(open, carry));
+            carry = open >> 63;
+        }
+        label->row_first[y + 1] = count;
+    }
+}
+
+// Union every pair of overlapping runs between two adjacent rows
+static void merge_rows(t_label *label, int y)
+{
+    long i = label->row_first[y - 1];
+    long i1 = label->row_first[y];
+    long j = label->row_first[y];
+    long j1 = label->row_first[y + 1];
+
+    while (i < i1 && j < j1)
+    {
+        if (label->run_start[i] < label->run_stop[j]
+            && label->run_start[j] < label->run_stop[i])
+            uf_union(label->parent, i, j);
+        if (label->run_stop[i] < label->run_stop[j])
+            i++;
+        else
+            j++;
+    }
+}
+
+// Record the runs of each row with their C/E counts, then union the band
+// internally. The row padding is wall, so no run crosses a row end.
+static void band_label(void *ctx, int band)
+{
+    t_label *label = ctx;
+    t_sim *sim = label->sim;
+    int y0 = band * label->band_rows;
+    int y1 = y0 + label->band_rows;
+    unsigned long open, carry, targets, edges, bit;
+    long run, seen;
+    int y, w, x, start_seen = 0;
+
+    if (y1 > sim->map_height)
+        y1 = sim->map_height;
+    for (y = y0; y < y1; y++)
+    {
+        run = label->row_first[y];
+        carry = 0;
+        seen = 0; // Targets in the row before the current word
+        for (w = 0; w < sim->stride / 64; w++)
+        {
+            open = ~map_mask64(grid_row(sim, y) + w * 64, '1', '1');
+            targets = map_mask64(grid_row(sim, y) + w * 64, 'C', 'E');
+            edges = RUN_STARTS(open, carry) | (~open & ((open << 1) | carry));
+            carry = open >> 63;
+            while (edges)
+            {
+                bit = edges & -edges;
+                x = w * 64 + __builtin_ctzl(edges);
+                if (open & bit)
+                {
+                    label->run_start[run] = x;
+                    start_seen = seen + __builtin_popcountl(targets & (bit - 1));
+                }
+                else
+                {
+                    label->run_stop[run] = x;
+                    label->run_targets[run] = seen + __builtin_popcountl(targets & (bit - 1))
+                                              - start_seen;
+                    label->parent[run] = run;
+                    run++;
+                }
+                edges &= edges - 1;
+            }
+            seen += __builtin_popcountl(targets);
+        }
+        if (y > y0)
+            merge_rows(label, y);
+    }
+}
+
+static void band_join(void *ctx, int band)
+{
+    t_label *label = ctx;
+
+    if (band > 0)
+        merge_rows(label, band * label->band_rows);
+}
+
+static void band_tally(void *ctx, int band)
+{
+    t_label *label = ctx;
+    int y1 = (band + 1) * label->band_rows;
+    long i, i1, reached = 0;
+
+    if (y1 > label->sim->map_height)
+        y1 = label->sim->map_height;
+    i1 = label->row_first[y1];
+    for (i = label->row_first[band * label->band_rows]; i < i1; i++)
+        if (label->run_targets[i] && uf_find(label->parent, i) == label->root)
+            reached += label->run_targets[i];
+    __atomic_fetch_add(&label->reached, reached, __ATOMIC_RELAXED);
+}
+
+// First run in reading order with a target outside the player's component
+static void find_miss(t_label *label, t_reach *miss)
+{
+    t_sim *sim = label->sim;
+    long i;
+    int y, x;
+
+    for (y = 0; y < sim->map_height; y++)
+    {
+        for (i = label->row_first[y]; i < label->row_first[y + 1]; i++)
+        {
+            if (!label->run_targets[i] || uf_find(label->parent, i) == label->root)
+                continue;
+            for (x = label->run_start[i]; x < label->run_stop[i]; x++)
+            {
+                if (SIM_CELL(sim, x, y) == 'C' || SIM_CELL(sim, x, y) == 'E')
+                {
+                    miss->x = x;
+                    miss->y = y;
+                    return;
+                }
+            }
+        }
+    }
+}
+
+int reach_parallel(t_sim *sim, const t_sim_layout *layout, t_pool *pool,
+                   t_reach *miss)
+{
+    t_arena_mark mark = arena_mark(&sim->arena);
+    t_label label;
+    long runs, i;
+    int bands, y, result;
+
+    label.sim = sim;
+    label.band_rows = (sim->map_height + pool_size(pool) * 4 - 1) / (pool_size(pool) * 4);
+    if (label.band_rows < REACH_MIN_BAND_ROWS)
+        label.band_rows = REACH_MIN_BAND_ROWS;
+    bands = (sim->map_height + label.band_rows - 1) / label.band_rows;
+    label.row_first = arena_alloc(&sim->arena, (sim->map_height + 1) * sizeof(long));
+    if (!label.row_first)
+        return (-1);
+
+    // Count the runs of every row to number them
+    pool_run(pool, band_count, &label, bands);
+    label.row_first[0] = 0;
+    for (y = 0; y < sim->map_height; y++)
+        label.row_first[y + 1] += label.row_first[y];
+    runs = label.row_first[sim->map_height];
+
+    label.run_start = arena_alloc(&sim->arena, runs * sizeof(int));
+    label.run_stop = arena_alloc(&sim->arena, runs * sizeof(int));
+    label.run_targets = arena_alloc(&sim->arena, runs * sizeof(int));
+    label.parent = arena_alloc(&sim->arena, runs * sizeof(int));
+    if (!label.run_start || !label.run_stop || !label.run_targets || !label.parent)
+    {
+        arena_rewind(&sim->arena, mark);
+        return (-1);
+    }
+    pool_run(pool, band_label, &label, bands);
+    pool_run(pool, band_join, &label, bands);
+
+    // The player's run
+    i = label.row_first[sim->player_y];
+    while (label.run_stop[i] <= sim->player_x)
+        i++;
+    label.root = uf_find(label.parent, i);
+
+    label.reached = 0;
+    pool_run(pool, band_tally, &label, bands);
+    result = (label.reached == layout->collectibles + layout->exits);
+    if (!result)
+        find_miss(&label, miss);
+    arena_rewind(&sim->arena, mark);
+    return (result);
+}
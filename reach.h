@@ -0,0 +1,28 @@
+#ifndef REACH_H
+#define REACH_H
+
+// Reachability of every C and the E from the player, on a loaded grid.
+// Two engines with the same answers: a scanline fill that stops early, for
+// normal maps, and a parallel connected-component labeling for huge ones.
+// Headless like sim.c: results are returned, never printed.
+
+#include "sim.h"
+#include "pool.h"
+
+#define REACH_PARALLEL_MIN_CELLS (1L << 18) // Smaller maps use the scanline fill
+#define REACH_MIN_BAND_ROWS 16              // Rows per band of the parallel engine
+
+// First target (C or E) the player cannot reach, in reading order
+typedef struct s_reach
+{
+    int x;
+    int y;
+} t_reach;
+
+// All engines return 1 if everything is reachable, 0 if not (with `miss`
+// filled in), -1 if memory ran out. Scratch memory comes from the level arena.
+int reach_scanline(t_sim *sim, const t_sim_layout *layout, t_reach *miss);
+int reach_parallel(t_sim *sim, const t_sim_layout *layout, t_pool *pool,
+                   t_reach *miss);
+
+#endif
@@ -0,0 +1,172 @@
+#include "replay.h"
+#include <stdlib.h>
+#include <string.h>
+
+// FNV-1a over the raw map file, so a replay is only run on the map it was
+// recorded on
+int replay_hash_file(const char *path, unsigned long long *hash)
+{
+    unsigned char buffer[4096];
+    size_t n, i;
+    FILE *file;
+
+    file = fopen(path, "rb");
+    if (!file)
+        return (0);
+    *hash = 0xCBF29CE484222325ULL;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        for (i = 0; i < n; i++)
+        {
+            *hash ^= buffer[i];
+            *hash *= 0x100000001B3ULL;
+        }
+    }
+    fclose(file);
+    return (1);
+}
+
+static void put_u16(FILE *file, unsigned int value)
+{
+    fputc(value & 0xFF, file);
+    fputc((value >> 8) & 0xFF, file);
+}
+
+static void put_u64(FILE *file, unsigned long long value)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+        fputc((int)((value >> (i * 8)) & 0xFF), file);
+}
+
+static void put_varint(FILE *file, unsigned int value)
+{
+    while (value >= 0x80)
+    {
+        fputc((int)((value & 0x7F) | 0x80), file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+static int get_u64(FILE *file, unsigned long long *value)
+{
+    int i, c;
+
+    *value = 0;
+    for (i = 0; i < 8; i++)
+    {
+        if ((c = fgetc(file)) == EOF)
+            return (0);
+        *value |= (unsigned long long)c << (i * 8);
+    }
+    return (1);
+}
+
+// Returns 1 on success, 0 on clean EOF, -1 on a truncated value
+static int get_varint(FILE *file, unsigned int *value)
+{
+    int c, shift = 0;
+
+    *value = 0;
+    while ((c = fgetc(file)) != EOF)
+    {
+        *value |= (unsigned int)(c & 0x7F) << shift;
+        if (!(c & 0x80))
+            return (1);
+        shift += 7;
+        if (shift > 28)
+            return (-1);
+    }
+    return (shift == 0 ? 0 : -1);
+}
+
+int replay_start_record(t_replay *replay, const char *path,
+                        unsigned long long map_hash, unsigned long long seed)
+{
+    replay->file = fopen(path, "wb");
+    if (!replay->file)
+        return (0);
+    replay->mode = REPLAY_RECORD;
+    replay->map_hash = map_hash;
+    replay->seed = seed;
+    replay->last_ms = 0;
+    fwrite("SLRP", 1, 4, replay->file);
+    put_u16(replay->file, REPLAY_VERSION);
+    put_u16(replay->file, 0);
+    put_u64(replay->file, map_hash);
+    put_u64(replay->file, seed);
+    return (1);
+}
+
+int replay_record_key(t_replay *replay, unsigned int time_ms, int keycode)
+{
+    if (replay->mode != REPLAY_RECORD || !replay->file)
+        return (0);
+    if (time_ms < replay->last_ms)
+        time_ms = replay->last_ms;
+    put_varint(replay->file, time_ms - replay->last_ms);
+    put_varint(replay->file, (unsigned int)keycode);
+    replay->last_ms = time_ms;
+    return (!ferror(replay->file));
+}
+
+int replay_load(t_replay *replay, const char *path)
+{
+    unsigned char header[8];
+    unsigned int delta, keycode;
+    unsigned int time_ms = 0;
+    int capacity = 256;
+    int status;
+    FILE *file;
+
+    file = fopen(path, "rb");
+    if (!file)
+        return (0);
+    if (fread(header, 1, 8, file) != 8 || memcmp(header, "SLRP", 4) != 0
+        || (header[4] | (header[5] << 8)) != REPLAY_VERSION
+        || !get_u64(file, &replay->map_hash) || !get_u64(file, &replay->seed))
+    {
+        fclose(file);
+        return (0);
+    }
+
+    replay->events = malloc(capacity * sizeof(t_replay_event));
+    replay->count = 0;
+    replay->next = 0;
+    while (replay->events && (status = get_varint(file, &delta)) == 1)
+    {
+        if (get_varint(file, &keycode) != 1)
+            break;
+        if (replay->count == capacity)
+        {
+            t_replay_event *grown;
+
+            capacity *= 2;
+            grown = realloc(replay->events, capacity * sizeof(t_replay_event));
+            if (!grown)
+                break;
+            replay->events = grown;
+        }
+        time_ms += delta;
+        replay->events[replay->count].time_ms = time_ms;
+        replay->events[replay->count].keycode = (int)keycode;
+        replay->count++;
+    }
+    fclose(file);
+    if (!replay->events)
+        return (0);
+    replay->mode = REPLAY_PLAY;
+    return (1);
+}
+
+void replay_close(t_replay *replay)
+{
+    if (replay->file)
+        fclose(replay->file);
+    replay->file = NULL;
+    free(replay->events);
+    replay->events = NULL;
+    replay->mode = REPLAY_OFF;
+}
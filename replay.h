@@ -0,0 +1,46 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// Input record/replay. A replay file is:
+//   "SLRP" | version (u16) | reserved (u16) | map hash (u64) | seed (u64)
+// followed by one entry per key press until EOF:
+//   delta_ms since the previous key (LEB128) | keycode (LEB128)
+// Times are game time, SIM_TICK_MS per simulation tick, so a key lands
+// between the same ticks however fast the replay runs.
+// All fixed-size fields are little-endian.
+
+#include <stdio.h>
+
+#define REPLAY_VERSION 2
+
+#define REPLAY_OFF    0
+#define REPLAY_RECORD 1
+#define REPLAY_PLAY   2
+
+typedef struct s_replay_event
+{
+    unsigned int    time_ms;    // Game time since the start of the run
+    int             keycode;
+} t_replay_event;
+
+typedef struct s_replay
+{
+    int                 mode;
+    int                 realtime;   // Play back with the recorded pacing
+    unsigned long long  map_hash;
+    unsigned long long  seed;
+    FILE                *file;      // Recording output
+    unsigned int        last_ms;    // Time of the last recorded key
+    t_replay_event      *events;    // Loaded key stream for playback
+    int                 count;
+    int                 next;       // Next event to feed
+} t_replay;
+
+int     replay_hash_file(const char *path, unsigned long long *hash);
+int     replay_start_record(t_replay *replay, const char *path,
+                            unsigned long long map_hash, unsigned long long seed);
+int     replay_record_key(t_replay *replay, unsigned int time_ms, int keycode);
+int     replay_load(t_replay *replay, const char *path);
+void    replay_close(t_replay *replay);
+
+#endif
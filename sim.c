@@ -0,0 +1,532 @@
+#include "sim.h"
+#include "map.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Drop the previous level and allocate a walled grid for the next one.
+// Rows are padded up to a cache line multiple; the padding after each row is
+// wall, which serves as the right border of that row and the left border of
+// the next. One all-wall row above and below closes the border.
+// The interior is left as wall for the loader to fill. Returns 0 on failure.
+int sim_alloc_grid(t_sim *sim, int width, int height)
+{
+    size_t size;
+    char *base;
+
+    arena_reset(&sim->arena);
+    sim->cells = NULL;
+    sim->flow = NULL;
+    sim->occupancy = NULL;
+    sim->free_rank = NULL;
+    sim->free_count = 0;
+    memset(&sim->enemies, 0, sizeof(sim->enemies));
+    sim->stride = (width + 1 + GRID_ALIGN - 1) / GRID_ALIGN * GRID_ALIGN;
+    size = (size_t)(height + 2) * sim->stride;
+    base = arena_alloc(&sim->arena, size);
+    if (!base)
+        return (0);
+    memset(base, '1', size);
+    sim->cells = base + sim->stride;
+    sim->map_width = width;
+    sim->map_height = height;
+    return (1);
+}
+
+// The generator state survives level changes, so a seed plus a key stream
+// reproduces a whole run
+void sim_seed(t_sim *sim, unsigned long long seed)
+{
+    sim->rng_state = seed;
+}
+
+// splitmix64, truncated to 32 bits
+unsigned int sim_rand(t_sim *sim)
+{
+    unsigned long long z;
+
+    sim->rng_state += 0x9E3779B97F4A7C15ULL;
+    z = sim->rng_state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return ((unsigned int)((z ^ (z >> 31)) >> 32));
+}
+
+// Start a level from the P/E/C positions recorded by the loader and reset the
+// per-level counters. The player cell is turned back into floor.
+// Returns 0 if there is no player.
+int sim_init_level(t_sim *sim, const t_sim_layout *layout)
+{
+    sim->collectibles = layout->collectibles;
+    sim->collected = 0;
+    sim->moves = 0;
+    sim->score = 0;
+    sim->status = SIM_PLAYING;
+    sim_clear_enemies(sim);
+    sim->enemy_move_counter = 0;
+
+    if (layout->players == 0)
+        return (0);
+    sim->player_x = layout->player_x;
+    sim->player_y = layout->player_y;
+    sim->exit_x = layout->exit_x;
+    sim->exit_y = layout->exit_y;
+
+    // Convert player position to empty space
+    SIM_CELL(sim, sim->player_x, sim->player_y) = '0';
+    return (1);
+}
+
+// Remove every enemy, keeping the storage for the next ones
+void sim_clear_enemies(t_sim *sim)
+{
+    t_enemies *e = &sim->enemies;
+    int i;
+
+    for (i = 0; i < e->count; i++)
+        if (e->active[i])
+            SIM_OCC_WORD(sim, e->x[i], e->y[i]) &= ~SIM_OCC_MASK(e->x[i]);
+    e->count = 0;
+}
+
+// Move the enemy arrays to a larger block of the level arena. The old block
+// stays behind until the level is dropped, which doubling keeps to less
+// than the final size.
+static int grow_enemies(t_sim *sim)
+{
+    t_enemies *e = &sim->enemies;
+    int capacity = e->capacity ? e->capacity * 2 : 16;
+    size_t ints = (size_t)capacity * sizeof(int);
+    char *block;
+
+    block = arena_alloc(&sim->arena, ints * 4 + (size_t)capacity * 2);
+    if (!block)
+        return (0);
+    if (e->count)
+    {
+        memcpy(block, e->x, (size_t)e->count * sizeof(int));
+        memcpy(block + ints, e->y, (size_t)e->count * sizeof(int));
+        memcpy(block + ints * 2, e->prev_x, (size_t)e->count * sizeof(int));
+        memcpy(block + ints * 3, e->prev_y, (size_t)e->count * sizeof(int));
+        memcpy(block + ints * 4, e->type, e->count);
+        memcpy(block + ints * 4 + capacity, e->active, e->count);
+    }
+    e->x = (int *)block;
+    e->y = (int *)(block + ints);
+    e->prev_x = (int *)(block + ints * 2);
+    e->prev_y = (int *)(block + ints * 3);
+    e->type = (unsigned char *)(block + ints * 4);
+    e->active = (unsigned char *)(block + ints * 4 + capacity);
+    e->capacity = capacity;
+    return (1);
+}
+
+// Put an enemy on a free cell. Returns its index, or -1 if another enemy
+// stands there or memory ran out.
+int sim_add_enemy(t_sim *sim, int x, int y, int type)
+{
+    // The border rows, plus a word on each side for the corner cells
+    size_t words = (size_t)(sim->map_height + 2) * sim->stride / 64 + 2;
+    t_enemies *e = &sim->enemies;
+    int i;
+
+    if (!sim->occupancy)
+    {
+        sim->occupancy = arena_alloc(&sim->arena, words * sizeof(unsigned long));
+        if (!sim->occupancy)
+            return (-1);
+        memset(sim->occupancy, 0, words * sizeof(unsigned long));
+        sim->occupancy += sim->stride / 64 + 1;
+    }
+    if (SIM_OCC(sim, x, y) || (e->count == e->capacity && !grow_enemies(sim)))
+        return (-1);
+    i = e->count++;
+    e->x[i] = x;
+    e->y[i] = y;
+    e->prev_x[i] = x;
+    e->prev_y[i] = y;
+    e->type[i] = type;
+    e->active[i] = 1;
+    SIM_OCC_WORD(sim, x, y) |= SIM_OCC_MASK(x);
+    return (i);
+}
+
+// Start a flow field over: walls hold the largest value, which no walk ever
+// reaches or goes through, and every other cell is unvisited
+static void clear_flow(t_sim *sim)
+{
+    long i, size = (long)(sim->map_height + 2) * sim->stride;
+    unsigned int *flow = sim->flow - sim->stride;
+    const char *cells = sim->cells - sim->stride;
+
+    for (i = 0; i < size; i++)
+        flow[i] = cells[i] == '1' ? 0xFFFFFFFFu : 0;
+    sim->flow_base = 2;
+}
+
+// Lay out the flow field and its queue in the level arena, once per level.
+// Like the grid the field has a row above and below, so that neighbors of
+// any cell can be read.
+static int alloc_flow(t_sim *sim)
+{
+    size_t size = (size_t)(sim->map_height + 2) * sim->stride;
+    unsigned int *base;
+
+    base = arena_alloc(&sim->arena, size * sizeof(unsigned int));
+    sim->flow_queue = arena_alloc(&sim->arena,
+                                  (size_t)sim->map_width * sim->map_height * sizeof(int));
+    if (!base || !sim->flow_queue)
+        return (0);
+    sim->flow = base + sim->stride;
+    clear_flow(sim);
+    return (1);
+}
+
+// Breadth-first walk distances from the player over every non-wall cell,
+// which is where enemies may go. A cell at distance d holds flow_base + d;
+// anything below flow_base is left over from an earlier field and counts as
+// unvisited, so the field never needs clearing. Enemy cells are tagged with
+// flow_base - 1, a value no field ever stores, and the walk stops once it
+// has reached all of them: each enemy only needs its own distance and its
+// neighbors' nearer ones, which are all set by then. It also covers at
+// least every cell less than `depth` moves away.
+// Returns the base of the new field.
+static unsigned int build_flow(t_sim *sim, unsigned int depth)
+{
+    long offset[4] = {-sim->stride, sim->stride, -1, 1};
+    unsigned int *flow = sim->flow;
+    unsigned int base, tag, value;
+    int *queue = sim->flow_queue;
+    long head = 0, tail = 0, i, n;
+    int remaining = 0, d, k;
+
+    // Start over long before the values could wrap around
+    if (sim->flow_base > 0xF0000000u)
+        clear_flow(sim);
+    base = sim->flow_base;
+    tag = base - 1;
+    for (k = 0; k < sim->enemies.count; k++)
+    {
+        i = (long)sim->enemies.y[k] * sim->stride + sim->enemies.x[k];
+        if (sim->enemies.active[k] && flow[i] != tag)
+        {
+            flow[i] = tag;
+            remaining++;
+        }
+    }
+
+    i = (long)sim->player_y * sim->stride + sim->player_x;
+    if (flow[i] == tag)
+        remaining--;
+    flow[i] = base;
+    queue[tail++] = i;
+    value = base;
+    while (head < tail && (remaining > 0 || flow[queue[head]] - base < depth))
+    {
+        i = queue[head++];
+        value = flow[i] + 1;
+        for (d = 0; d < 4; d++)
+        {
+            // The wall border keeps n inside the grid, and walls read as visited
+            n = i + offset[d];
+            if (flow[n] >= base)
+                continue;
+            if (flow[n] == tag)
+                remaining--;
+            flow[n] = value;
+            queue[tail++] = n;
+        }
+    }
+
+    // Skip a value past the farthest one written so the next tag is unused
+    sim->flow_base = value + 2;
+    return (base);
+}
+
+// Index the floor cells of a level for sim_spawn_enemies. The grid is read
+// as words of 64 cells (rows are padded to whole words with wall); each word
+// gets the number of floor cells before it, so the n-th floor cell is found
+// with a binary search and a bit select. The index is a sixteenth of the
+// grid's size. Called by the loader; returns 0 if memory ran out.
+int sim_index_free_cells(t_sim *sim)
+{
+    long words = (long)sim->map_height * sim->stride / 64;
+    long w;
+
+    sim->free_count = 0;
+    sim->free_rank = arena_alloc(&sim->arena, words * sizeof(int));
+    if (!sim->free_rank)
+        return (0);
+    for (w = 0; w < words; w++)
+    {
+        sim->free_rank[w] = sim->free_count;
+        sim->free_count += __builtin_popcountl(map_mask64(sim->cells + w * 64, '0', '0'));
+    }
+    return (1);
+}
+
+// Offset (y * stride + x) of the n-th floor cell of the grid. Floor never
+// turns into anything else during a level, so every word holds at least as
+// many floor cells as when it was indexed.
+static int free_cell(t_sim *sim, long n)
+{
+    long low = 0, high = (long)sim->map_height * sim->stride / 64, mid;
+    unsigned long mask;
+
+    // Last word with at most n floor cells before it
+    while (high - low > 1)
+    {
+        mid = (low + high) / 2;
+        if (sim->free_rank[mid] <= n)
+            low = mid;
+        else
+            high = mid;
+    }
+    mask = map_mask64(sim->cells + low * 64, '0', '0');
+    for (n -= sim->free_rank[low]; n > 0; n--)
+        mask &= mask - 1;
+    return (low * 64 + __builtin_ctzl(mask));
+}
+
+// A floor cell can take a new enemy if neither the player nor an enemy is
+// there and the flow field from `base` does not put it less than
+// `min_distance` moves from the player. Cells the player cannot be walked to
+// from are never near.
+static int can_spawn(t_sim *sim, int cell, unsigned int base, int min_distance)
+{
+    unsigned int value = sim->flow[cell];
+
+    if (cell == sim->player_y * sim->stride + sim->player_x
+        || (sim->occupancy && (sim->occupancy[cell >> 6] >> (cell & 63)) & 1))
+        return (0);
+    return (value < base || value - base >= (unsigned int)min_distance);
+}
+
+// First floor cell that can take a new enemy, in reading order from `from`
+// and wrapping around, or -1 if there is none
+static int sweep_free_cells(t_sim *sim, int from, unsigned int base, int min_distance)
+{
+    long words = (long)sim->map_height * sim->stride / 64;
+    unsigned long mask;
+    long w, k;
+    int cell;
+
+    for (k = 0; k < words; k++)
+    {
+        w = (from / 64 + k) % words;
+        for (mask = map_mask64(sim->cells + w * 64, '0', '0'); mask; mask &= mask - 1)
+        {
+            cell = w * 64 + __builtin_ctzl(mask);
+            if (can_spawn(sim, cell, base, min_distance))
+                return (cell);
+        }
+    }
+    return (-1);
+}
+
+// Replace the enemies with `count` new ones on distinct floor cells at least
+// `min_distance` moves from the player, drawn with the seeded generator.
+// A walk bounded by `min_distance` marks the cells too near; draws are then
+// uniform over the floor cells, whatever share of the map is wall. After
+// SPAWN_TRIES misses (a crowded level) the grid is swept from the last draw
+// instead. Returns how many were placed: fewer than `count` only if no floor
+// cell is left that far away.
+int sim_spawn_enemies(t_sim *sim, int count, int min_distance)
+{
+    unsigned int base;
+    int i, tries, cell, spawned = 0;
+
+    sim_clear_enemies(sim);
+    if ((!sim->free_rank && !sim_index_free_cells(sim)) || sim->free_count == 0
+        || (!sim->flow && !alloc_flow(sim)))
+        return (0);
+    if (min_distance < 0)
+        min_distance = 0;
+    base = build_flow(sim, min_distance);
+
+    // Enemy types cycle: norminette, segfault, memory_leak
+    for (i = 0; i < count; i++)
+    {
+        cell = 0;
+        for (tries = 0; tries < SPAWN_TRIES; tries++)
+        {
+            cell = free_cell(sim, sim_rand(sim) % sim->free_count);
+            if (can_spawn(sim, cell, base, min_distance))
+                break;
+        }
+        if (tries == SPAWN_TRIES && (cell = sweep_free_cells(sim, cell, base, min_distance)) < 0)
+            break;
+        if (sim_add_enemy(sim, cell % sim->stride, cell / sim->stride, i % 3) >= 0)
+            spawned++;
+    }
+    return (spawned);
+}
+
+// Step every enemy one cell downhill on a distance field shared by all of
+// them, so they route around walls at a cost of one walk per enemy tick.
+// Among equally good cells, the one along the axis where the player is
+// farther wins. Enemies the player cannot be walked to from stay put.
+void sim_move_enemies(t_sim *sim)
+{
+    // Neighbor order: vertical axis first, then horizontal first
+    static const int step[2][4][2] = {
+        {{0, -1}, {0, 1}, {-1, 0}, {1, 0}},
+        {{-1, 0}, {1, 0}, {0, -1}, {0, 1}}};
+    t_enemies *e = &sim->enemies;
+    unsigned int base, best, here;
+    int i, d, x, y, nx, ny, best_x, best_y, horizontal;
+
+    if (e->count == 0 || (!sim->flow && !alloc_flow(sim)))
+        return;
+    base = build_flow(sim, 0);
+    for (i = 0; i < e->count; i++)
+    {
+        if (!e->active[i])
+            continue;
+        x = e->x[i];
+        y = e->y[i];
+        e->prev_x[i] = x;
+        e->prev_y[i] = y;
+        best = sim->flow[(long)y * sim->stride + x];
+        if (best < base)
+            continue;
+
+        horizontal = abs(sim->player_x - x) >= abs(sim->player_y - y);
+        best_x = x;
+        best_y = y;
+        for (d = 0; d < 4; d++)
+        {
+            nx = x + step[horizontal][d][0];
+            ny = y + step[horizontal][d][1];
+            here = sim->flow[(long)ny * sim->stride + nx];
+            if (here < base || here >= best || SIM_OCC(sim, nx, ny))
+                continue;
+            best = here;
+            best_x = nx;
+            best_y = ny;
+        }
+        SIM_OCC_WORD(sim, x, y) &= ~SIM_OCC_MASK(x);
+        SIM_OCC_WORD(sim, best_x, best_y) |= SIM_OCC_MASK(best_x);
+        e->x[i] = best_x;
+        e->y[i] = best_y;
+    }
+}
+
+// An enemy on the player's cell ends the level
+static void check_caught(t_sim *sim, t_sim_events *events)
+{
+    t_enemies *e = &sim->enemies;
+    int i;
+
+    if (!sim->occupancy || !SIM_OCC(sim, sim->player_x, sim->player_y))
+        return;
+
+    // Only the rare catch looks for which enemy it was
+    for (i = 0; i < e->count; i++)
+    {
+        if (e->active[i] && e->x[i] == sim->player_x && e->y[i] == sim->player_y)
+        {
+            sim->status = SIM_CAUGHT;
+            events->caught_by = e->type[i];
+            events->flags |= SIM_EV_CAUGHT;
+            return;
+        }
+    }
+}
+
+// Advance the game by one player action. Returns the event flags.
+// Enemies do not move here, see sim_tick.
+int sim_step(t_sim *sim, int action, t_sim_events *events)
+{
+    int new_x = sim->player_x;
+    int new_y = sim->player_y;
+
+    events->flags = 0;
+    events->from_x = sim->player_x;
+    events->from_y = sim->player_y;
+    events->points = 0;
+    events->caught_by = -1;
+
+    if (sim->status != SIM_PLAYING)
+        return (0);
+
+    if (action == SIM_UP)
+        new_y--;
+    else if (action == SIM_DOWN)
+        new_y++;
+    else if (action == SIM_LEFT)
+        new_x--;
+    else if (action == SIM_RIGHT)
+        new_x++;
+    else
+        return (0);
+
+    // Check bounds
+    if (new_x < 0 || new_x >= sim->map_width ||
+        new_y < 0 || new_y >= sim->map_height)
+        return (events->flags = SIM_EV_BLOCKED_BOUNDS);
+
+    // Check for walls
+    if (SIM_CELL(sim, new_x, new_y) == '1')
+        return (events->flags = SIM_EV_BLOCKED_WALL);
+
+    // The exit only lets the player through once everything is collected
+    if (SIM_CELL(sim, new_x, new_y) == 'E')
+    {
+        if (sim->collected != sim->collectibles)
+            return (events->flags = SIM_EV_EXIT_LOCKED);
+        sim->status = SIM_ESCAPED;
+        return (events->flags = SIM_EV_LEVEL_COMPLETE);
+    }
+
+    // Move player
+    sim->player_x = new_x;
+    sim->player_y = new_y;
+    sim->moves++;
+    events->flags |= SIM_EV_MOVED;
+
+    // Check for collectible
+    if (SIM_CELL(sim, new_x, new_y) == 'C')
+    {
+        SIM_CELL(sim, new_x, new_y) = '0'; // Remove collectible
+        sim->collected++;
+
+        // Simple scoring: 100 points max per level. Testing >= keeps a level
+        // whose count is off from ever dividing by zero
+        if (sim->collected >= sim->collectibles)
+            events->points = 100 - sim->score; // Last one rounds up to exactly 100
+        else
+            events->points = 100 / sim->collectibles;
+        sim->score += events->points;
+
+        events->flags |= SIM_EV_COLLECTED;
+        if (sim->collected == sim->collectibles)
+            events->flags |= SIM_EV_EXIT_OPENED;
+    }
+
+    // Walking into an enemy
+    check_caught(sim, events);
+    return (events->flags);
+}
+
+// Advance the game by one fixed time step (SIM_TICK_MS): enemies move every
+// ENEMY_MOVE_TICKS ticks, whatever the player does. Returns the event flags.
+int sim_tick(t_sim *sim, t_sim_events *events)
+{
+    events->flags = 0;
+    events->from_x = sim->player_x;
+    events->from_y = sim->player_y;
+    events->points = 0;
+    events->caught_by = -1;
+
+    if (sim->status != SIM_PLAYING)
+        return (0);
+    sim->enemy_move_counter++;
+    if (sim->enemy_move_counter >= ENEMY_MOVE_TICKS)
+    {
+        sim_move_enemies(sim);
+        sim->enemy_move_counter = 0;
+        events->flags |= SIM_EV_ENEMIES_MOVED;
+        check_caught(sim, events);
+    }
+    return (events->flags);
+}
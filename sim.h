@@ -0,0 +1,127 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Headless game rules: no MLX, no printf, no exit.
+// The MLX hooks in so_long_safe.c are a thin adapter over this API.
+
+#include "arena.h"
+
+#define MAX_WIDTH 16384     // Largest map the loader accepts
+#define MAX_HEIGHT 16384
+#define GRID_ALIGN 64       // Row stride granularity (one cache line)
+#define SIM_TICK_MS 10      // Fixed simulation time step, see sim_tick
+#define ENEMY_MOVE_TICKS 50 // Enemies move once every N ticks
+#define SPAWN_TRIES 64      // Random draws per enemy before sweeping the free cells
+
+// Player actions
+#define SIM_NONE  0
+#define SIM_UP    1
+#define SIM_DOWN  2
+#define SIM_LEFT  3
+#define SIM_RIGHT 4
+
+// Event flags reported by sim_step
+#define SIM_EV_BLOCKED_BOUNDS  (1 << 0)
+#define SIM_EV_BLOCKED_WALL    (1 << 1)
+#define SIM_EV_EXIT_LOCKED     (1 << 2)  // Reached the exit with collectibles left
+#define SIM_EV_LEVEL_COMPLETE  (1 << 3)  // Reached the exit with everything collected
+#define SIM_EV_MOVED           (1 << 4)
+#define SIM_EV_COLLECTED       (1 << 5)
+#define SIM_EV_EXIT_OPENED     (1 << 6)  // Last collectible picked up
+#define SIM_EV_ENEMIES_MOVED   (1 << 7)
+#define SIM_EV_CAUGHT          (1 << 8)  // An enemy is on the player's cell
+
+// Map cell at (x, y). The grid has a one-cell wall border, so x in [-1, width]
+// and y in [-1, height] are valid and neighbors never need a bounds check.
+#define SIM_CELL(sim, x, y) ((sim)->cells[(long)(y) * (sim)->stride + (x)])
+
+// Whether an enemy stands on cell (x, y): one bit per cell, in the same
+// layout as SIM_CELL. The stride is a multiple of 64, so the bit within a
+// word only depends on x. Only valid once sim->occupancy is allocated (the
+// first enemy added).
+#define SIM_OCC_WORD(sim, x, y) ((sim)->occupancy[((long)(y) * (sim)->stride + (x)) >> 6])
+#define SIM_OCC_MASK(x) (1UL << ((x) & 63))
+#define SIM_OCC(sim, x, y) ((SIM_OCC_WORD(sim, x, y) & SIM_OCC_MASK(x)) != 0)
+
+// Level status
+#define SIM_PLAYING 0
+#define SIM_CAUGHT  1
+#define SIM_ESCAPED 2
+
+// Enemies as parallel arrays in the level arena, grown by doubling. At most
+// one active enemy stands on a cell, which the occupancy bits record.
+typedef struct s_enemies
+{
+    int             *x;
+    int             *y;
+    int             *prev_x;    // Position before the last enemy move
+    int             *prev_y;
+    unsigned char   *type;      // 0=norminette, 1=segfault, 2=memory_leak
+    unsigned char   *active;
+    int             count;
+    int             capacity;
+} t_enemies;
+
+typedef struct s_sim
+{
+    char        *cells;     // Cell (0,0) of the level grid, see SIM_CELL
+    int         stride;     // Bytes per grid row, a multiple of GRID_ALIGN
+    int         map_width;
+    int         map_height;
+    t_arena     arena;      // Level lifetime memory: the grid and its companions
+    int         player_x;
+    int         player_y;
+    int         exit_x;
+    int         exit_y;
+    int         collectibles;
+    int         collected;
+    int         moves;
+    int         score;
+    int         status;
+    t_enemies   enemies;
+    unsigned long *occupancy; // See SIM_OCC; NULL until the first enemy is added
+    int         enemy_move_counter; // Ticks since the enemies last moved
+    unsigned int *flow;     // Walk distance to the player, laid out like cells; NULL until enemies move
+    unsigned int flow_base; // Value of the player cell in the current field, see sim_move_enemies
+    int         *flow_queue; // Walk queue of the field, one entry per cell
+    int         *free_rank; // Floor cells before each 64-cell word of the grid, see sim_index_free_cells
+    long        free_count; // Floor cells in the whole grid
+    unsigned long long rng_state; // Seeded generator so runs can be replayed
+} t_sim;
+
+// Where the loader found P/E/C while reading the level file
+typedef struct s_sim_layout
+{
+    int players;      // Number of 'P' cells
+    int exits;        // Number of 'E' cells
+    int collectibles;
+    int player_x;     // Last 'P' seen
+    int player_y;
+    int exit_x;       // Last 'E' seen
+    int exit_y;
+    int compiled;     // Loaded from a .berc: validated when it was compiled
+    int exit_distance; // Shortest walk from P to E, compiled levels only
+} t_sim_layout;
+
+typedef struct s_sim_events
+{
+    int flags;        // SIM_EV_* bits
+    int from_x;       // Player cell before the step
+    int from_y;
+    int points;       // Score gained by a collection
+    int caught_by;    // Enemy type when SIM_EV_CAUGHT is set
+} t_sim_events;
+
+int     sim_alloc_grid(t_sim *sim, int width, int height);
+void    sim_seed(t_sim *sim, unsigned long long seed);
+unsigned int sim_rand(t_sim *sim);
+int     sim_init_level(t_sim *sim, const t_sim_layout *layout);
+void    sim_clear_enemies(t_sim *sim);
+int     sim_add_enemy(t_sim *sim, int x, int y, int type);
+int     sim_index_free_cells(t_sim *sim);
+int     sim_spawn_enemies(t_sim *sim, int count, int min_distance);
+void    sim_move_enemies(t_sim *sim);
+int     sim_step(t_sim *sim, int action, t_sim_events *events);
+int     sim_tick(t_sim *sim, t_sim_events *events);
+
+#endif
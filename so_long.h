@@ -0,0 +1,251 @@
+#ifndef SO_LONG_H
+#define SO_LONG_H
+
+#include "minilibx-linux/mlx.h"
+#include "sim.h"
+#include "map.h"
+#include "reach.h"
+#include "pool.h"
+#include "replay.h"
+#include "input.h"
+#include "log.h"
+#include "profile.h"
+#include "berc.h"
+#include "atlas.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#define TILE_SIZE 32
+#define SPRITE_COUNT 8                      // Images in t_sprites
+#define SPRITE_DIR "assets"
+#define SPRITE_ATLAS "assets/sprites.atlas" // Packed by `make`, see atlas.h
+#define MAX_DIRTY 256 // Damaged tiles tracked per frame before falling back to a full redraw
+#define COLLECT_ANIM_MAX_RADIUS 30 // Radius of the collect circle on its last frame
+#define VIEW_MAX_W 30       // Viewport size in tiles; smaller maps are shown whole
+#define VIEW_MAX_H 17
+#define CAMERA_MARGIN 4     // Tiles kept between the player and the view edge
+#define FRAME_NS (1000000000LL / 60)    // Display frame budget (60 Hz)
+#define SIM_TICK_NS (SIM_TICK_MS * 1000000LL)
+#define MAX_CATCHUP_NS 250000000LL      // Longest stall the simulation catches up on
+#define ENEMY_SLIDE_TICKS 15    // Enemies glide to their new cell over this many ticks
+#define COLLECT_ANIM_TICKS 25   // Length of the collect circle animation
+#define PROF_HUD_REFRESH 30     // Loop frames between profiler overlay updates
+#define PROF_HUD_W 180          // Profiler overlay box, top right of the view
+#define PROF_HUD_H 165
+#define ENEMY_COUNT 3           // Enemies spawned per level
+#define ENEMY_SPAWN_DISTANCE 5  // Fewest moves between the player and a new enemy
+
+// Bitmap font: 5x7 glyphs on a 6 pixel advance, one extra row/column for the shadow
+#define GLYPH_W 5
+#define GLYPH_H 7
+#define GLYPH_ADVANCE 6
+#define TEXT_MAX 32
+
+// Cached text slots, re-rendered only when their string or color changes
+#define TEXT_EVAL 0
+#define TEXT_MOVES 1
+#define TEXT_STATUS 2
+#define TEXT_EXIT 3
+#define TEXT_SCORE 4
+#define TEXT_PEER 5
+#define TEXT_ENEMY 6 // One slot per enemy type (6, 7, 8)
+#define TEXT_MENU_TITLE 9
+#define TEXT_MENU_RESTART 10
+#define TEXT_MENU_QUIT 11
+#define TEXT_PROF 12 // Profiler overlay: header, then one slot per phase
+#define TEXT_SLOTS (TEXT_PROF + 1 + PROF_PHASES)
+
+#define TRANSPARENT_MASK 0xFF000000 // MLX marks XPM "None" pixels with a full alpha byte
+
+// How a sprite is composited (MLX alpha byte: 0x00 = opaque, 0xFF = transparent)
+#define BLEND_OPAQUE 0 // Plain row copies
+#define BLEND_KEYED  1 // Fully transparent pixels are skipped
+#define BLEND_ALPHA  2 // Partial transparency, blended per channel
+
+typedef struct s_image
+{
+    void    *img;
+    char    *addr;      // Raw pixel memory from mlx_get_data_addr
+    int     bpp;
+    int     line_len;   // Bytes per row (may be padded)
+    int     endian;
+    int     width;
+    int     height;
+    int     blend;      // BLEND_* mode picked from the pixel data at load
+} t_image;
+
+typedef struct s_text
+{
+    char            str[TEXT_MAX];
+    unsigned int    color;
+    int             shadow;
+    t_image         image;  // Pre-rendered keyed pixels (malloc'd, not an MLX image)
+} t_text;
+
+typedef struct s_sprites
+{
+    t_image floor;
+    t_image wall;
+    t_image player;
+    t_image player_walk;
+    t_image collectible;
+    t_image exit_closed;
+    t_image exit_open;
+    t_image enemy;
+} t_sprites;
+
+// Command line options
+typedef struct s_options
+{
+    char                *map_file;
+    char                *record_file;   // --record <file>
+    char                *replay_file;   // --replay <file>
+    int                 realtime;       // --realtime: replay with recorded pacing
+    int                 has_seed;       // --seed <n>
+    int                 compile;        // --compile: write <map_file>c and exit
+    int                 quiet;          // --quiet: only errors and the move count
+    int                 log_json;       // --log-json: log as JSON lines
+    char                *profile_file;  // --profile <file>: frame profile CSV written at exit
+    unsigned long long  seed;
+} t_options;
+
+// Next level, loaded and validated on a background thread during play
+typedef struct s_prefetch
+{
+    pthread_t       thread;
+    int             running;    // Thread started and not joined yet
+    int             eval;       // Eval level being loaded
+    char            *filename;
+    t_sim           sim;        // Staging grid and arena, swapped in by prefetch_swap
+    t_sim_layout    layout;
+    unsigned char   *dirty;
+    int             ready;      // Loaded and every target reachable
+    long long       load_ns;    // Time the background load took
+} t_prefetch;
+
+typedef struct s_game
+{
+    void        *mlx;
+    void        *window;
+    t_sim       sim;      // Game rules and level state (headless)
+    t_sim_layout layout;  // P/E/C found by load_map, checked by validate_map
+    int         current_eval;
+    int         victory;
+    int         game_over;
+    int         game_over_reason; // 0=enemy collision, 1=completed
+    int         player_anim_frame; // 0 or 1 for player animation
+    int         collect_anim_x; // X position of collection animation
+    int         collect_anim_y; // Y position of collection animation
+    int         collect_anim_timer; // Animation timer (0 = no animation)
+    int         collect_anim_drawn; // Circle is in the frame and must be erased
+    t_sprites   sprites;  // Sprite assets
+    t_image     frame;    // Off-screen backbuffer, presented once per frame
+    t_image     static_layer; // Floor + walls + closed exit under the view, baked when it moves
+    int         view_w;   // Viewport size in tiles, the window size
+    int         view_h;
+    int         cam_x;    // Map tile shown in the top-left corner
+    int         cam_y;
+    t_text      texts[TEXT_SLOTS]; // HUD and label strings rendered into the frame
+    t_profile   prof;           // Render phase timings
+    int         show_profile;   // Profiler overlay toggled with P
+    char        prof_lines[PROF_PHASES][TEXT_MAX]; // Overlay rows, re-formatted when emptied
+    int         prof_hud_age;   // Loop frames since the overlay was refreshed
+    char        *profile_file;  // CSV written at exit, NULL for none
+    unsigned char *dirty;                       // map_width * map_height, 1 if a visible tile must be repainted
+    int         dirty_tiles[MAX_DIRTY];         // Damaged tiles as y * map_width + x
+    int         dirty_count;
+    int         full_redraw;                    // Repaint every tile (level load, overflow)
+    t_replay    replay;                         // Key stream being recorded or played back
+    t_input     input;                          // Live keys waiting for the next frame
+    t_pool      pool;                           // Workers for huge-map level checks, started on demand
+    t_prefetch  prefetch;                       // Next eval level, loading in the background
+    long long   start_ns;                       // Monotonic time the run started
+    long long   ticks;                          // Simulation ticks run since the start
+    long long   tick_debt_ns;                   // Time the simulation is behind, under a tick after each frame
+    long long   last_loop_ns;                   // When game_loop last ran
+    long long   next_frame_ns;                  // When the next frame is due
+    long long   enemy_move_tick;                // Tick the enemies last moved on
+    int         enemy_slide_px;                 // How far enemies have glided from their previous cell
+    int         enemy_slide_drawn;              // Enemies were drawn between two cells last frame
+} t_game;
+
+// Function prototypes
+int     load_sprites(t_game *game);
+int     load_sprite_atlas(t_game *game, char *path);
+int     decode_sprites(t_game *game);
+void    destroy_sprites(t_game *game);
+int     load_map(t_game *game, char *filename);
+int     compile_map(t_game *game, char *filename, char *output);
+int     read_level(t_sim *sim, t_sim_layout *layout, unsigned char **dirty,
+                   char *filename, t_map_error *err);
+int     start_pool(t_game *game);
+int     level_reach(t_game *game, t_sim *sim, const t_sim_layout *layout, t_reach *miss);
+char    *eval_map_file(int eval);
+void    prefetch_start(t_game *game);
+int     prefetch_take(t_game *game, int eval);
+void    prefetch_swap(t_game *game);
+void    prefetch_cancel(t_game *game);
+void    prefetch_destroy(t_game *game);
+int     validate_map(t_game *game);
+void    report_map_error(t_map_error *err);
+int     check_file_extension(char *filename);
+int     flood_fill_check(t_game *game);
+void    fatal_error(char *message);
+int     next_eval(t_game *game);
+void    render_game(t_game *game);
+int     key_hook(int keycode, t_game *game);
+int     close_game(t_game *game);
+void    move_player(t_game *game, int action);
+void    report_caught(t_game *game, int caught_by);
+void    spawn_enemies(t_game *game);
+void    render_enemies(t_game *game);
+int     enemy_screen_x(t_game *game, int i);
+int     enemy_screen_y(t_game *game, int i);
+void    render_ui(t_game *game);
+void    render_game_over_menu(t_game *game);
+void    render_profile(t_game *game);
+void    toggle_profile(t_game *game);
+int     restart_game(t_game *game, char *filename);
+int     parse_args(int argc, char **argv, t_options *opts);
+long long monotonic_ns(void);
+void    set_hooks(t_game *game);
+int     on_key(int keycode, t_game *game);
+int     game_loop(t_game *game);
+void    game_tick(t_game *game);
+int     load_image(t_game *game, t_image *image, char *path);
+int     create_image(t_game *game, t_image *image, int width, int height);
+void    destroy_image(t_game *game, t_image *image);
+int     create_frame(t_game *game);
+void    init_blitter(void);
+void    blit_sprite(t_image *dst, t_image *src, int x, int y);
+void    present_frame(t_game *game);
+void    copy_image_rect(t_image *dst, t_image *src, int x, int y, int w, int h);
+void    bake_static_layer(t_game *game);
+void    reset_camera(t_game *game);
+int     follow_player(t_game *game);
+int     in_view(t_game *game, int x, int y);
+void    fill_rect(t_image *img, int x, int y, int w, int h, unsigned int color);
+void    fill_rect_alpha(t_image *img, int x, int y, int w, int h, unsigned int color);
+void    fill_circle(t_image *img, int cx, int cy, int radius, unsigned int color);
+void    draw_circle(t_image *img, int cx, int cy, int radius, unsigned int color);
+void    render_labels(t_game *game);
+void    init_glyph_atlas(void);
+void    draw_text(t_game *game, int slot, int x, int y, unsigned int color, int shadow, char *str);
+void    destroy_texts(t_game *game);
+void    mark_tile_dirty(t_game *game, int x, int y);
+void    mark_rect_dirty(t_game *game, int px, int py, int w, int h);
+void    mark_entity_dirty(t_game *game, int x, int y);
+void    mark_collect_anim_dirty(t_game *game);
+void    mark_profile_dirty(t_game *game);
+void    mark_full_redraw(t_game *game);
+
+#endif
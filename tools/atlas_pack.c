@@ -0,0 +1,38 @@
+#include "../atlas.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Build step: decode the sprite XPMs once and pack them into an atlas.
+// Usage: atlas_pack <atlas> <sprite.xpm>...
+int main(int argc, char **argv)
+{
+    t_atlas_sprite *sprites;
+    int count = argc - 2;
+    int i, ok = 1;
+
+    if (count < 1 || count > 0xFFFF)
+    {
+        fprintf(stderr, "Usage: %s <atlas> <sprite.xpm>...\n", argv[0]);
+        return (1);
+    }
+    sprites = calloc(count, sizeof(*sprites));
+    if (!sprites)
+        return (1);
+    for (i = 0; i < count && ok; i++)
+    {
+        ok = xpm_decode(argv[i + 2], &sprites[i]);
+        if (!ok)
+            fprintf(stderr, "Error\nCannot decode %s\n", argv[i + 2]);
+    }
+    if (ok && !atlas_write(argv[1], sprites, count))
+    {
+        fprintf(stderr, "Error\nCannot write %s\n", argv[1]);
+        ok = 0;
+    }
+    if (ok)
+        printf("🎨 Packed %d sprites into %s\n", count, argv[1]);
+    for (i = 0; i < count; i++)
+        free(sprites[i].pixels);
+    free(sprites);
+    return (!ok);
+}